@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "../src/collision_detector.h"
+
+/*
+ * Сравнение скалярной TryCollectPoint и пакетной TryCollectPoints
+ * для одного отрезка и разного количества предметов.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double MeasureNsPerItem(size_t items_count, size_t repeat, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t r = 0; r < repeat; ++r) {
+        fn();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return elapsed / static_cast<double>(repeat * items_count);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> coord(-100.0, 100.0);
+
+    const geom::Point2D a{ -50, 0.5 };
+    const geom::Point2D b{ 50, 0.5 };
+
+    std::cout << std::setw(10) << "items" << std::setw(16) << "scalar ns/item"
+        << std::setw(16) << "batch ns/item" << std::setw(10) << "hits" << '\n';
+
+    for (size_t count : { 10, 100, 1000, 10000, 100000 }) {
+        collision_detector::PackedItems items;
+        items.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            items.Add(i, { coord(gen), coord(gen) }, collision_detector::ITEM_COLLIDER_SIZE);
+        }
+
+        const size_t repeat = std::max<size_t>(10, 20'000'000 / count);
+        size_t scalar_hits = 0;
+        size_t batch_hits = 0;
+
+        double scalar_ns = MeasureNsPerItem(count, repeat, [&] {
+            scalar_hits = 0;
+            for (size_t i = 0; i < count; ++i) {
+                auto res = collision_detector::TryCollectPoint(a, b, { items.x[i], items.y[i] });
+                scalar_hits += res.IsCollected(collision_detector::DOG_COLLIDER_SIZE + items.width[i]);
+            }
+        });
+
+        collision_detector::BatchCollectionResult batch;
+        double batch_ns = MeasureNsPerItem(count, repeat, [&] {
+            collision_detector::TryCollectPoints(a, b, collision_detector::DOG_COLLIDER_SIZE, items, batch);
+            batch_hits = 0;
+            for (auto hit : batch.hit_mask) {
+                batch_hits += hit;
+            }
+        });
+
+        if (scalar_hits != batch_hits) {
+            std::cerr << "hit count mismatch for " << count << " items\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << std::setw(10) << count << std::setw(16) << std::fixed << std::setprecision(3) << scalar_ns
+            << std::setw(16) << batch_ns << std::setw(10) << batch_hits << '\n';
+    }
+}
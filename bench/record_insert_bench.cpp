@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+#include "../src/database.h"
+
+/*
+ * Запись пачки рекордов в PostgreSQL: подготовленный INSERT с массивами (им пишет RecordWriter)
+ * против отдельных INSERT через pqxx::pipeline. Адрес базы берется из GAME_DB_URL.
+ * Строки остаются в retired_players, поэтому запускать стоит на отдельной базе.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// сколько запросов конвейер копит перед отправкой
+constexpr int PIPELINE_RETAIN = 256;
+
+// pqxx::pipeline принимает только текст запроса, поэтому значения подставляются через quote
+std::string InsertRecordQuery(const pqxx::transaction_base& tx, const db::GameRecords& gr) {
+    std::string query = "INSERT INTO retired_players (id, name, score, play_time_ms) VALUES (";
+    query += tx.quote(util::PlayerId::New().ToString());
+    query += ',';
+    query += tx.quote(gr.name);
+    query += ',';
+    query += std::to_string(gr.score);
+    query += ',';
+    query += std::to_string(std::llrint(gr.played_time));
+    query += ");";
+    return query;
+}
+
+// та же пачка отдельными INSERT: запросы уходят подряд, ответы собираются после отправки
+void WriteRecordsPipelined(pqxx::connection& conn, const std::vector<db::GameRecords>& records) {
+    pqxx::work work{ conn };
+    {
+        pqxx::pipeline pipe{ work };
+        pipe.retain(PIPELINE_RETAIN);
+        for (const db::GameRecords& gr : records) {
+            pipe.insert(InsertRecordQuery(work, gr));
+        }
+        // ошибка любого INSERT бросает исключение здесь, транзакция тогда откатывается целиком
+        while (!pipe.empty()) {
+            pipe.retrieve();
+        }
+    }
+    work.commit();
+}
+
+template <typename Fn>
+double MeasureMsPerFlush(size_t repeat, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t r = 0; r < repeat; ++r) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / static_cast<double>(repeat);
+}
+
+std::vector<db::GameRecords> MakeRecords(size_t count) {
+    std::vector<db::GameRecords> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        records.push_back({ "bench " + std::to_string(i % 1000), i % 500, static_cast<double>(i % 3600) * 1000 + 250 });
+    }
+    return records;
+}
+
+}  // namespace
+
+int main() {
+    const char* url = std::getenv("GAME_DB_URL");
+    if (url == nullptr) {
+        std::cerr << "GAME_DB_URL is not specified\n";
+        return EXIT_FAILURE;
+    }
+    // Database создает таблицу и пишет подготовленным INSERT, конвейеру нужно свое соединение
+    db::Database database({ url, 1 });
+    pqxx::connection pipeline_conn{ url };
+
+    std::cout << std::setw(8) << "rows" << std::setw(16) << "array ms" << std::setw(16) << "pipeline ms"
+        << std::setw(16) << "array us/row" << std::setw(16) << "pipe us/row" << '\n';
+
+    for (size_t count : { 1, 100, 10000 }) {
+        const auto records = MakeRecords(count);
+        const size_t repeat = std::max<size_t>(3, 2000 / count);
+
+        // первый проход прогревает соединение и кэш планов
+        database.WriteRecords(records);
+        WriteRecordsPipelined(pipeline_conn, records);
+
+        double array_ms = MeasureMsPerFlush(repeat, [&] {
+            database.WriteRecords(records);
+        });
+        double pipeline_ms = MeasureMsPerFlush(repeat, [&] {
+            WriteRecordsPipelined(pipeline_conn, records);
+        });
+
+        std::cout << std::setw(8) << count << std::fixed << std::setprecision(3)
+            << std::setw(16) << array_ms << std::setw(16) << pipeline_ms
+            << std::setprecision(1)
+            << std::setw(16) << array_ms * 1000 / count << std::setw(16) << pipeline_ms * 1000 / count << '\n';
+    }
+}
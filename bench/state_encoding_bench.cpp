@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <boost/json.hpp>
+#include "../src/msgpack.h"
+#include "../src/state_encoding.h"
+
+/*
+ * Сравнение JSON и MessagePack для тела ответа /game/state:
+ * размер, время кодирования из снимка и время разбора клиентом до чисел.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double MeasureNsPerPlayer(size_t players_count, size_t repeat, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t r = 0; r < repeat; ++r) {
+        fn();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return elapsed / static_cast<double>(repeat * players_count);
+}
+
+std::unique_ptr<app::SessionSnapshot> MakeSnapshot(size_t players_count, std::mt19937& gen) {
+    std::uniform_real_distribution<double> coord(0.0, 100.0);
+    std::uniform_int_distribution<int> type(0, 3);
+
+    auto snapshot = std::make_unique<app::SessionSnapshot>();
+    snapshot->tick = 1000;
+    snapshot->removed = std::make_shared<const std::vector<app::RemovedEntity>>();
+    for (size_t i = 0; i < players_count; ++i) {
+        app::PlayerSnapshot player{ static_cast<int>(i), "Player " + std::to_string(i), { coord(gen), coord(gen) },
+            { 1.5, 0.0 }, model::Direction::East, {}, i * 10 };
+        for (size_t j = 0; j < i % 3; ++j) {
+            player.bag.push_back(model::Trophy(i * 3 + j, type(gen), { 0, 0 }));
+        }
+        snapshot->players.push_back(std::move(player));
+    }
+    for (size_t i = 0; i < players_count; ++i) {
+        snapshot->loot.push_back({ i, model::Trophy(i, type(gen), { coord(gen), coord(gen) }) });
+    }
+    return snapshot;
+}
+
+// клиент достает из ответа координаты всех игроков и предметов
+double DecodeJson(const std::string& body) {
+    double sum = 0;
+    boost::json::value value = boost::json::parse(body);
+    for (const auto& player : value.as_object().at("players").as_object()) {
+        const auto& pos = player.value().as_object().at("pos").as_array();
+        sum += pos[0].as_double() + pos[1].as_double();
+    }
+    for (const auto& loot : value.as_object().at("lostObjects").as_object()) {
+        const auto& pos = loot.value().as_object().at("pos").as_array();
+        sum += pos[0].as_double() + pos[1].as_double();
+    }
+    return sum;
+}
+
+double DecodeMsgPack(const std::string& body) {
+    double sum = 0;
+    wire::MsgPackReader reader(body);
+    reader.ReadArrayHeader();
+    reader.ReadUint();
+    reader.ReadUint();
+    for (size_t i = reader.ReadArrayHeader(); i > 0; --i) {
+        reader.ReadArrayHeader();
+        reader.ReadUint();
+        sum += reader.ReadDouble();
+        sum += reader.ReadDouble();
+        for (int field = 0; field < 5; ++field) {
+            reader.Skip();
+        }
+    }
+    for (size_t i = reader.ReadArrayHeader(); i > 0; --i) {
+        reader.ReadArrayHeader();
+        reader.ReadUint();
+        reader.ReadInt();
+        sum += reader.ReadDouble();
+        sum += reader.ReadDouble();
+    }
+    return sum;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 gen(1);
+
+    std::cout << std::setw(8) << "players" << std::setw(12) << "json bytes" << std::setw(12) << "mp bytes"
+        << std::setw(14) << "json enc ns" << std::setw(12) << "mp enc ns"
+        << std::setw(14) << "json dec ns" << std::setw(12) << "mp dec ns" << '\n';
+
+    for (size_t count : { 10, 100, 1000, 10000 }) {
+        const auto snapshot = MakeSnapshot(count, gen);
+        const size_t repeat = std::max<size_t>(5, 200'000 / count);
+
+        std::string json_body;
+        std::string msgpack_body;
+        double json_enc = MeasureNsPerPlayer(count, repeat, [&] {
+            json_body = encoding::EncodeStateJson(*snapshot);
+        });
+        double msgpack_enc = MeasureNsPerPlayer(count, repeat, [&] {
+            msgpack_body = encoding::EncodeStateMsgPack(*snapshot);
+        });
+
+        double json_sum = 0;
+        double msgpack_sum = 0;
+        double json_dec = MeasureNsPerPlayer(count, repeat, [&] {
+            json_sum = DecodeJson(json_body);
+        });
+        double msgpack_dec = MeasureNsPerPlayer(count, repeat, [&] {
+            msgpack_sum = DecodeMsgPack(msgpack_body);
+        });
+
+        // JSON печатает double с округлением, поэтому суммы сравниваются приблизительно
+        if (std::abs(json_sum - msgpack_sum) > 1e-6 * std::abs(msgpack_sum)) {
+            std::cerr << "decoded values differ for " << count << " players\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << std::setw(8) << count << std::setw(12) << json_body.size() << std::setw(12) << msgpack_body.size()
+            << std::setw(14) << std::fixed << std::setprecision(1) << json_enc << std::setw(12) << msgpack_enc
+            << std::setw(14) << json_dec << std::setw(12) << msgpack_dec << '\n';
+    }
+}
@@ -12,57 +12,61 @@ namespace api_handler {
         return response;
     }
 
-    StringResponse Api::GetStringResponse(const std::string& str, unsigned http_version) {
-        StringResponse response = GetTemplateResponse(http_version);
+    SharedOrStringResponse Api::GetStringResponse(const std::string& str, std::string_view if_none_match, unsigned http_version,
+        BodyFormat format) {
+        const MapCatalogue::Entry* entry = nullptr;
 
-            if (str == API_MAP) {
-                std::ostringstream ss;
-                PrintMaps(ss);
-                response.body() = ss.str();
-            }
-            else if (str.find(API_MAP) != std::string::npos && str.size() > MAP_NAME_PREFIX_SIZE) {
-                model::Map::Id id(str.substr(MAP_NAME_PREFIX_SIZE));
-                if (apl_.GetMap(id) != nullptr) {
-                    std::ostringstream ss;
-                    PrintMap(apl_.GetMap(id), ss);
-                    response.body() = ss.str();
-                }
-                else {
-                    response.result(http::status::not_found);
-                    response.body() = NO_MAP;
-                }
-            }
-            else {
-                response.result(http::status::bad_request);
-                response.body() = BAD_REQUEST;
+        if (str == API_MAP) {
+            entry = &maps_.GetList(format);
+        }
+        else if (str.find(API_MAP) != std::string::npos && str.size() > MAP_NAME_PREFIX_SIZE) {
+            entry = maps_.FindMap(str.substr(MAP_NAME_PREFIX_SIZE), format);
+            if (entry == nullptr) {
+                return GetErrorResponse(http_version, http::status::not_found, NO_MAP);
             }
+        }
+        else {
+            return GetErrorResponse(http_version, http::status::bad_request, BAD_REQUEST);
+        }
+
+        SharedStringResponse response{ std::move(GetTemplateResponse(http_version).base()) };
+        SetBodyFormat(response, format);
+        response.set(http::field::etag, entry->etag);
+        if (!if_none_match.empty() && MapCatalogue::MatchesETag(if_none_match, entry->etag)) {
+            response.result(http::status::not_modified);
+        }
+        else {
+            response.body() = entry->body;
+        }
         response.prepare_payload();
         return response;
     }
 
-    StringResponse Api::GetUserResponse(const std::string& str, unsigned http_version) {
-        StringResponse response = GetTemplateResponse(http_version);
-
+    SharedOrStringResponse Api::GetUserResponse(const std::string& str, unsigned http_version, BodyFormat format) {
         std::string auth_token = str.substr(7, str.size());
 
         if (!TokenIsVadid(auth_token)) {
             return GetErrorResponse(http_version, http::status::unauthorized, INVALID_TOKEN);
         }
 
-        if (!apl_.HasToken(auth_token)) {
+        auto session = sim_.ReadSession(auth_token);
+        if (!session) {
             return GetErrorResponse(http_version, http::status::unauthorized, TOKEN_NOT_FOUND);
         }
-        
-        response.body() = GetUserList(auth_token);
+
+        SharedStringResponse response{ std::move(GetTemplateResponse(http_version).base()) };
+        SetBodyFormat(response, format);
+        response.set(GAME_TICK_HEADER, std::to_string(session->tick));
+        response.body() = session->GetPlayersBody(static_cast<size_t>(format), [format](const app::SessionSnapshot& snapshot) {
+            return format == BodyFormat::MsgPack ? encoding::EncodePlayersMsgPack(snapshot) : encoding::EncodePlayersJson(snapshot);
+        });
         response.prepare_payload();
         return response;
     }
 
-    StringResponse Api::PostUserAuthResponse(const std::string& str, unsigned http_version) {
+    std::optional<StringResponse> Api::PostUserAuthResponse(const std::string& str, unsigned http_version, const Reply& reply) {
         json::value req_mes = json::parse(str);
 
-        StringResponse response = GetTemplateResponse(http_version);
-
         std::string name;
         std::string map_id;
         try {
@@ -73,39 +77,106 @@ namespace api_handler {
             return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
         }
 
-        app::PlayerInfo player_info;
-
-        try {
-            player_info.Write( apl_.JoinGame(map_id, name));
+        //   ,         
+        if (name.empty()) {
+            return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
         }
-        catch (const app::Application::JoinPlayerErrorCode& jpec) {
-            if (jpec == app::Application::JoinPlayerErrorCode::wrong_name) {
-                return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
-            }
-            if (jpec == app::Application::JoinPlayerErrorCode::wrong_map) {
-                return GetErrorResponse(http_version, http::status::not_found, NO_MAP);
-            }
+        if (apl_.GetMap(map_id) == nullptr) {
+            return GetErrorResponse(http_version, http::status::not_found, NO_MAP);
         }
 
-        response.body() = GetAnswerUserAuthSuccess(player_info);
-        response.prepare_payload();
-        return response;
+        sim_.Submit([this, map_id, name, http_version, reply]() -> app::Simulation::Deferred {
+            //         
+            try {
+                StringResponse response = GetTemplateResponse(http_version);
+                app::PlayerInfo player_info;
+                player_info.Write(apl_.JoinGame(map_id, name));
+                response.body() = GetAnswerUserAuthSuccess(player_info);
+                response.prepare_payload();
+                return DeferReply(reply, std::move(response));
+            }
+            catch (app::Application::JoinPlayerErrorCode code) {
+                if (code == app::Application::wrong_map) {
+                    return DeferReply(reply, GetErrorResponse(http_version, http::status::not_found, NO_MAP));
+                }
+                return DeferReply(reply, GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR));
+            }
+            catch (...) {
+                return DeferReply(reply, GetErrorResponse(http_version, http::status::internal_server_error, SERVER_ERROR));
+            }
+        });
+        return std::nullopt;
     }
     
-    StringResponse Api::GetStateResponse(const std::string& str, unsigned http_version) {
-        StringResponse response = GetTemplateResponse(http_version);
+    app::Simulation::Deferred Api::DeferReply(const Reply& reply, StringResponse&& response) {
+        return [reply, response = std::move(response)]() mutable {
+            reply(std::move(response));
+        };
+    }
 
+    std::optional<SharedOrStringResponse> Api::GetStateResponse(const std::string& str, const std::string& target,
+        unsigned http_version, BodyFormat format, const SharedReply& reply) {
         std::string auth_token = str.substr(7, str.size());
 
         if (!TokenIsVadid(auth_token)) {
             return GetErrorResponse(http_version, http::status::unauthorized, INVALID_TOKEN);
         }
 
-        if (!apl_.HasToken(auth_token)) {
+        auto [since, since_valid] = GetSinceParam(target);
+        if (!since_valid) {
+            return GetErrorResponse(http_version, http::status::bad_request, INVALID_SINCE);
+        }
+
+        auto [wait_next, wait_valid] = GetWaitParam(target);
+        if (!wait_valid) {
+            return GetErrorResponse(http_version, http::status::bad_request, INVALID_WAIT);
+        }
+
+        auto session = sim_.ReadSession(auth_token);
+        if (!session) {
             return GetErrorResponse(http_version, http::status::unauthorized, TOKEN_NOT_FOUND);
         }
 
-        response.body() = GetPlayersState(auth_token);
+        if (!wait_next) {
+            return MakeStateResponse(*session, since, http_version, format);
+        }
+
+        //    ;         .
+        //       ,     -
+        sim_.WaitNextSnapshot(auth_token, session->version, LONG_POLL_TIMEOUT,
+            [reply, since = since, http_version, format, executor = response_executor_](app::Simulation::SessionView next) {
+                net::post(executor, [reply, since, http_version, format, next = std::move(next)] {
+                    if (!next) {
+                        reply(GetErrorResponse(http_version, http::status::unauthorized, TOKEN_NOT_FOUND));
+                        return;
+                    }
+                    reply(MakeStateResponse(*next, since, http_version, format));
+                });
+            });
+        return std::nullopt;
+    }
+
+    SharedStringResponse Api::MakeStateResponse(const app::SessionSnapshot& session, std::optional<std::uint64_t> since,
+        unsigned http_version, BodyFormat format) {
+        SharedStringResponse response{ std::move(GetTemplateResponse(http_version).base()) };
+        SetBodyFormat(response, format);
+        response.set(GAME_TICK_HEADER, std::to_string(session.tick));
+        if (since && session.CanDiffSince(*since)) {
+            response.set(GAME_STATE_HEADER, GAME_STATE_DELTA);
+            response.body() = session.GetDeltaBody(static_cast<size_t>(format), *since,
+                [format](const app::SessionSnapshot& snapshot, std::uint64_t since) {
+                    return format == BodyFormat::MsgPack ? encoding::EncodeStateMsgPack(snapshot, since)
+                        : encoding::EncodeStateJson(snapshot, since);
+                });
+        }
+        else {
+            //   since        ,
+            //          
+            response.set(GAME_STATE_HEADER, GAME_STATE_FULL);
+            response.body() = session.GetStateBody(static_cast<size_t>(format), [format](const app::SessionSnapshot& snapshot) {
+                return format == BodyFormat::MsgPack ? encoding::EncodeStateMsgPack(snapshot) : encoding::EncodeStateJson(snapshot);
+            });
+        }
         response.prepare_payload();
         return response;
     }
@@ -148,11 +219,17 @@ namespace api_handler {
             return GetErrorResponse(http_version, http::status::unauthorized, INVALID_TOKEN);
         }
 
-        if (!apl_.HasToken(auth_token)) {
+        if (!sim_.ReadSession(auth_token)) {
             return GetErrorResponse(http_version, http::status::unauthorized, TOKEN_NOT_FOUND);
         }
 
-        ChangeMoveDirection(auth_token, dir);
+        sim_.Submit([this, auth_token, dir]() -> app::Simulation::Deferred {
+            //     ,     
+            if (apl_.HasToken(auth_token)) {
+                ChangeMoveDirection(auth_token, dir);
+            }
+            return {};
+        });
 
         json::object result;
         response.body() = json::serialize(result);
@@ -160,7 +237,103 @@ namespace api_handler {
         return response;
     }
 
-    StringResponse Api::SetTickAndGetResponse(const std::string& str, unsigned http_version) {
+    StringResponse Api::PostBatchMoveResponse(const std::string& str, unsigned http_version) {
+        struct Action {
+            std::string token;
+            std::string dir;
+        };
+
+        json::value req_mes;
+        try {
+            req_mes = json::parse(str);
+        }
+        catch (std::exception) {
+            return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
+        }
+        const json::array* entries = req_mes.if_array();
+        if (entries == nullptr) {
+            return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
+        }
+        if (entries->size() > MAX_ACTION_BATCH) {
+            return GetErrorResponse(http_version, http::status::bad_request, TOO_MANY_ACTIONS);
+        }
+
+        //   -  
+        std::vector<std::string_view> codes(entries->size());
+        std::vector<Action> actions;
+        std::vector<std::string> tokens;
+        actions.reserve(entries->size());
+        tokens.reserve(entries->size());
+
+        size_t index = 0;
+        for (const auto& entry : *entries) {
+            const json::object* fields = entry.if_object();
+            const json::value* token = fields ? fields->if_contains(TOKEN_STR) : nullptr;
+            const json::value* move = fields ? fields->if_contains(MOVE_STR) : nullptr;
+            if (token == nullptr || !token->is_string() || !TokenIsVadid(token->as_string().c_str())) {
+                codes[index] = CODE_INVALID_TOKEN;
+            }
+            else if (move == nullptr || !move->is_string() || !MoveIsValid(move->as_string().c_str())) {
+                codes[index] = CODE_INVALID_ARGUMENT;
+            }
+            else {
+                tokens.push_back(token->as_string().c_str());
+            }
+            ++index;
+        }
+
+        //         
+        std::vector<bool> known = sim_.HasTokens(tokens);
+        size_t token_index = 0;
+        index = 0;
+        for (const auto& entry : *entries) {
+            if (codes[index].empty()) {
+                if (known[token_index]) {
+                    actions.push_back({ std::move(tokens[token_index]), entry.as_object().at(MOVE_STR).as_string().c_str() });
+                }
+                else {
+                    codes[index] = CODE_UNKNOWN_TOKEN;
+                }
+                ++token_index;
+            }
+            ++index;
+        }
+
+        if (!actions.empty()) {
+            sim_.Submit([this, actions = std::move(actions)]() -> app::Simulation::Deferred {
+                for (const auto& action : actions) {
+                    //     ,     
+                    if (apl_.HasToken(action.token)) {
+                        ChangeMoveDirection(action.token, action.dir);
+                    }
+                }
+                return {};
+            });
+        }
+
+        StringResponse response = GetTemplateResponse(http_version);
+        std::string body;
+        body.reserve(2 + codes.size() * 32);
+        wire::JsonWriter writer(body);
+        writer.BeginArray();
+        for (std::string_view code : codes) {
+            writer.BeginObject();
+            writer.Key("status");
+            writer.Uint(static_cast<unsigned>(code.empty() ? http::status::ok
+                : code == CODE_UNKNOWN_TOKEN || code == CODE_INVALID_TOKEN ? http::status::unauthorized : http::status::bad_request));
+            if (!code.empty()) {
+                writer.Key("code");
+                writer.String(code);
+            }
+            writer.EndObject();
+        }
+        writer.EndArray();
+        response.body() = std::move(body);
+        response.prepare_payload();
+        return response;
+    }
+
+    std::optional<StringResponse> Api::SetTickAndGetResponse(const std::string& str, unsigned http_version, const Reply& reply) {
         if (!apl_.isSelfMode()) {
             return GetErrorResponse(http_version, http::status::bad_request, BAD_REQUEST);
         }
@@ -170,8 +343,6 @@ namespace api_handler {
 
         json::value req_mes = json::parse(str);
 
-        StringResponse response = GetTemplateResponse(http_version);
-
         int delta_time;
 
         try {
@@ -184,17 +355,25 @@ namespace api_handler {
             return GetErrorResponse(http_version, http::status::bad_request, PARSE_JSON_ERROR);
         }
 
-        UpdateWorldState(delta_time);
+        //     ,        
+        sim_.Submit([this, delta_time, http_version, reply]() -> app::Simulation::Deferred {
+            try {
+                apl_.UpdateWorldState(delta_time);
+            }
+            catch (...) {
+                return DeferReply(reply, GetErrorResponse(http_version, http::status::internal_server_error, SERVER_ERROR));
+            }
 
-        json::object result;
-        response.body() = json::serialize(result);
-        response.prepare_payload();
-        return response;
+            StringResponse response = GetTemplateResponse(http_version);
+            json::object result;
+            response.body() = json::serialize(result);
+            response.prepare_payload();
+            return DeferReply(reply, std::move(response));
+        });
+        return std::nullopt;
     }
 
-    StringResponse Api::GetRecordsResponse(const std::string& str, unsigned http_version) {
-        StringResponse response = GetTemplateResponse(http_version);
-
+    SharedOrStringResponse Api::GetRecordsResponse(const std::string& str, unsigned http_version) {
         int offset, max_elem;
         
         offset = db::DEFAULT_OFFSET;
@@ -213,11 +392,38 @@ namespace api_handler {
             max_elem = std::stoi(str_max_elem);
         }
 
-        if (max_elem > 100 || max_elem < 0) {
+        if (max_elem > 100 || max_elem < 0 || offset < 0) {
+            return GetErrorResponse(http_version, http::status::bad_request, BAD_REQUEST);
+        }
+
+        auto [cursor, cursor_valid] = GetRecordCursorParam(str);
+        if (!cursor_valid || (cursor && pos_start != std::string::npos)) {
+            return GetErrorResponse(http_version, http::status::bad_request, BAD_REQUEST);
+        }
+
+        //       ,    
+        SharedStringResponse response{ std::move(GetTemplateResponse(http_version).base()) };
+        response.body() = std::make_shared<const std::string>(cursor
+            ? encoding::EncodeRecordsJson(apl_.GetRecordsAfter(*cursor, max_elem))
+            : GetRecordTable(offset, max_elem));
+        response.prepare_payload();
+        return response;
+    }
+
+    StringResponse Api::GetRecordRankResponse(const std::string& str, unsigned http_version) {
+        auto name_param = FindQueryParam(str, NAME_PARAM_STR);
+        if (!name_param) {
             return GetErrorResponse(http_version, http::status::bad_request, BAD_REQUEST);
         }
+        std::string name(*name_param);
 
-        response.body() = GetRecordTable(offset, max_elem);
+        auto rank = apl_.FindRecordRank(name);
+        if (!rank) {
+            return GetErrorResponse(http_version, http::status::not_found, RECORD_NOT_FOUND);
+        }
+
+        StringResponse response = GetTemplateResponse(http_version);
+        response.body() = encoding::EncodeRecordRankJson(rank->place, rank->record);
         response.prepare_payload();
         return response;
     }
@@ -225,13 +431,10 @@ namespace api_handler {
     void Api::ChangeMoveDirection(const std::string& auth, const std::string& dir){
         double speed = apl_.GetSession(auth)->GetMap()->GetDogSpeedOnMap();
         if (dir.empty()) {
-            apl_.GetPlayerByToken(auth)->GetDog()->SetSpeed(model::ZEROSPEED);
+            apl_.ChangeDogMovement(auth, std::nullopt);
         }
         else {
-            apl_.GetPlayerByToken(auth)->GetDog()->EraseStayTime();
-            std::pair<model::Speed, model::Direction> pair_s_d = GetSpeedDirection(dir, speed);
-            apl_.GetPlayerByToken(auth)->GetDog()->SetSpeed(pair_s_d.first);
-            apl_.GetPlayerByToken(auth)->GetDog()->SetDirection(pair_s_d.second); 
+            apl_.ChangeDogMovement(auth, GetSpeedDirection(dir, speed));
         }
     }
 
@@ -256,6 +459,10 @@ namespace api_handler {
     }
 
 
+    bool Api::MoveIsValid(const std::string& dir) {
+        return dir.empty() || dir == "U" || dir == "D" || dir == "L" || dir == "R";
+    }
+
     std::string Api::URL_encode(const std::string& str) {
         std::string result;
         for (size_t i = 0; i < str.size(); ++i) {
@@ -298,12 +505,15 @@ namespace api_handler {
         return dist(gen);
     }
 
-    bool Api::TokenIsVadid(const std::string& str) {
-        return str.size() == 32;
+    BodyFormat Api::GetBodyFormat(std::string_view accept) {
+        if (accept.find(CONT_TYPE_MSGPACK) != std::string_view::npos || accept.find(CONT_TYPE_X_MSGPACK) != std::string_view::npos) {
+            return BodyFormat::MsgPack;
+        }
+        return BodyFormat::Json;
     }
 
-    void Api::UpdateWorldState(int delta_time) {
-        apl_.UpdateWorldState(delta_time);
+    bool Api::TokenIsVadid(const std::string& str) {
+        return str.size() == 32;
     }
 
     std::string Api::GetAnswerUserAuthSuccess(const app::PlayerInfo& pi) const {
@@ -312,161 +522,75 @@ namespace api_handler {
         return ss.str();
     }
 
-    std::string Api::GetUserList(const std::string& token) const {
-        const model::GameSession* session = apl_.GetSession(token);
-        boost::json::object result;
-
-        for (const auto& player : apl_.GetPlayersList()) {
-            if (player.second.get()->GetSession() == session) {
-                json::object player_info;
-                player_info["name"] = player.second.get()->GetName();
-                result[std::to_string(player.first)] = player_info;
+    std::optional<std::string_view> Api::FindQueryParam(std::string_view target, std::string_view key) {
+        size_t separator = target.find('?');
+        while (separator != std::string_view::npos) {
+            size_t begin = separator + 1;
+            size_t end = std::min(target.find('&', begin), target.size());
+            std::string_view param = target.substr(begin, end - begin);
+            if (param.starts_with(key)) {
+                return param.substr(key.size());
             }
+            separator = end == target.size() ? std::string_view::npos : end;
         }
-
-        return boost::json::serialize(result);
+        return std::nullopt;
     }
 
-    std::string Api::GetPlayersState(const std::string& token) const {
-        const model::GameSession* session = apl_.GetSession(token);
-        boost::json::object result;
-        boost::json::object players_json;
-        boost::json::object trophy_json;
-
-        for (const auto& player : apl_.GetPlayersList()) {
-            if (player.second.get()->GetSession() == session) {
-                boost::json::object player_info;
-                boost::json::array pos_array = {
-                    player.second.get()->GetDog()->GetPosition().x_pos,
-                    player.second.get()->GetDog()->GetPosition().y_pos
-                };
-                boost::json::array speed_array = {
-                    player.second.get()->GetDog()->GetSpeed().h_speed,
-                    player.second.get()->GetDog()->GetSpeed().v_speed
-                };
-                std::ostringstream oss;
-                oss << player.second.get()->GetDog()->GetDirection();
-                boost::json::array bag_array;
-                boost::json::object b_id, b_type;
-                for (const auto& bi : player.second.get()->GetDog()->GetItemFromBag()) {
-                    b_id["id"] = bi.GetId();
-                    b_type["type"] = bi.GetType();
-                    bag_array.push_back({ b_id,b_type });
-                }
-
-                player_info["pos"] = pos_array;
-                player_info["speed"] = speed_array;
-                player_info["dir"] = oss.str();
-                player_info["bag"] = bag_array;
-                player_info["score"] = player.second.get()->GetDog()->GetScore();
-
-
-                players_json[std::to_string(player.first)] = player_info;
-            }
+    std::pair<std::optional<std::uint64_t>, bool> Api::GetSinceParam(const std::string& target) {
+        auto value = FindQueryParam(target, SINCE_STR);
+        if (!value) {
+            return { std::nullopt, true };
         }
-        for (const auto& loot : session->GetTrophyList()) {
-            boost::json::object trophy_info;
-            boost::json::array pos_array = {
-                    loot.second.GetPosition().x_pos,
-                    loot.second.GetPosition().y_pos
-            };
-            trophy_info["type"] = loot.second.GetType();
-            trophy_info["pos"] = pos_array;
-            trophy_json[std::to_string(loot.first)] = trophy_info;
-        }
-
-        result["players"] = players_json;
-        result["lostObjects"] = trophy_json;
-
-        return boost::json::serialize(result);
-    }
-
-    const void Api::PrintMap(const model::Map* map, std::ostream& out) const {
-        using namespace boost::json;
-        object json_map;
-
-        json_map[ID_STR.data()] = *map->GetId();
-        json_map[NAME_STR.data()] = map->GetName();
 
-        array roads_array;
-        for (const auto& road : map->GetRoads()) {
-            roads_array.push_back(PrintRoadAsJson(road));
+        const char* begin = value->data();
+        const char* end = value->data() + value->size();
+        std::uint64_t since = 0;
+        auto [ptr, ec] = std::from_chars(begin, end, since);
+        if (begin == end || ec != std::errc{} || ptr != end) {
+            return { std::nullopt, false };
         }
-        json_map[ROADS_STR.data()] = roads_array;
-
-        array buildings_array;
-        for (const auto& build : map->GetBuildings()) {
-            buildings_array.push_back(PrintBuildingAsJson(build));
-        }
-        json_map[BUILDINGS_STR.data()] = buildings_array;
-
-        array offices_array;
-        for (const auto& office : map->GetOffices()) {
-            offices_array.push_back(PrintOfficeAsJson(office));
-        }
-        json_map[OFFICES_STR.data()] = offices_array;
-
-        json_map[LOOT_TYPES_STR.data()] = apl_.GetTrophies(*map->GetId());
-
-        out << serialize(json_map);
+        return { since, true };
     }
 
-    const json::object Api::PrintRoadAsJson(const model::Road& road) const {
-        json::object road_object;
-        road_object[X0_STR.data()] = road.GetStart().x;
-        road_object[Y0_STR.data()] = road.GetStart().y;
-        if (road.IsHorizontal()) {
-            road_object["x1"] = road.GetEnd().x;
-        }
-        else {
-            road_object["y1"] = road.GetEnd().y;
-        }
-        return road_object;
+    std::pair<std::optional<db::RecordCursor>, bool> Api::GetRecordCursorParam(const std::string& target) {
+        auto score = FindQueryParam(target, db::AFTER_SCORE_STR);
+        auto play_time = FindQueryParam(target, db::AFTER_PLAY_TIME_STR);
+        auto name = FindQueryParam(target, db::AFTER_NAME_STR);
+        if (!score && !play_time && !name) {
+            return { std::nullopt, true };
+        }
+        if (!score || !play_time || !name) {
+            return { std::nullopt, false };
+        }
+
+        db::RecordCursor cursor;
+        auto [score_end, score_ec] = std::from_chars(score->data(), score->data() + score->size(), cursor.score);
+        double seconds = 0;
+        auto [time_end, time_ec] = std::from_chars(play_time->data(), play_time->data() + play_time->size(), seconds);
+        if (score->empty() || score_ec != std::errc{} || score_end != score->data() + score->size()
+            || play_time->empty() || time_ec != std::errc{} || time_end != play_time->data() + play_time->size()
+            || !std::isfinite(seconds) || seconds < 0) {
+            return { std::nullopt, false };
+        }
+        //        ,     
+        cursor.play_time_ms = std::llround(seconds * 1000);
+        //   ,  &  =      
+        cursor.name = URL_encode(std::string(*name));
+        return { std::move(cursor), true };
     }
 
-    const json::object Api::PrintBuildingAsJson(const model::Building& build) const {
-        json::object building_object;
-        building_object[X_STR.data()] = build.GetBounds().position.x;
-        building_object[Y_STR.data()] = build.GetBounds().position.y;
-        building_object["w"] = build.GetBounds().size.width;
-        building_object["h"] = build.GetBounds().size.height;
-        return building_object;
-    }
-
-    const json::object Api::PrintOfficeAsJson(const model::Office& office) const {
-        json::object office_object;
-        office_object[ID_STR.data()] = *office.GetId();
-        office_object[X_STR.data()] = office.GetPosition().x;
-        office_object[Y_STR.data()] = office.GetPosition().y;
-        office_object["offsetX"] = office.GetOffset().dx;
-        office_object["offsetY"] = office.GetOffset().dy;
-        return office_object;
-    }
-
-    const void Api::PrintMaps( std::ostream& out) const {
-        using namespace boost::json;
-
-        json::array maps_array;
-
-        for (const auto& map : apl_.GetMaps()) {
-            json::object map_object;
-            map_object[ID_STR.data()] = *map.GetId();
-            map_object[NAME_STR.data()] = map.GetName();
-            maps_array.push_back(map_object);
+    std::pair<bool, bool> Api::GetWaitParam(const std::string& target) {
+        auto value = FindQueryParam(target, WAIT_STR);
+        if (!value) {
+            return { false, true };
         }
-
-        out << serialize(maps_array);
+        if (*value != WAIT_NEXT) {
+            return { false, false };
+        }
+        return { true, true };
     }
 
     const std::string Api::GetRecordTable(int start, int max) {
-        json::array record;
-        for (const auto& rec : apl_.GetRecords(start, max)) {
-            boost::json::object rec_info;
-            rec_info["name"] = rec.name;
-            rec_info["score"] = rec.score;
-            rec_info["playTime"] = rec.played_time;
-            record.push_back(rec_info);
-        }
-        return serialize(record);
+        return encoding::EncodeRecordsJson(apl_.GetRecords(start, max));
     }
 }
\ No newline at end of file
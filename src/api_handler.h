@@ -1,37 +1,75 @@
 #pragma once
 #include <random> 
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
 #include <boost/json.hpp>
 #include "app.h"
 #include "api_handler_static_name.h"
+#include "json_writer.h"
+#include "map_catalogue.h"
+#include "shared_string_body.h"
+#include "state_encoding.h"
+#include "simulation.h"
 
 namespace api_handler {
 
     namespace beast = boost::beast;
     namespace http = beast::http;
     namespace json = boost::json;
+    namespace net = boost::asio;
 
     using StringResponse = http::response<http::string_body>;
+    using SharedStringResponse = http_server::SharedStringResponse;
+    // ответ с общим телом или ошибка
+    using SharedOrStringResponse = std::variant<StringResponse, SharedStringResponse>;
 
     class Api {
     public:
+        // отправка ответа, который будет готов только после обработки команды в потоке симуляции
+        using Reply = std::function<void(StringResponse&& response)>;
+        using SharedReply = std::function<void(SharedOrStringResponse&& response)>;
 
-        explicit Api(app::Application& apl) :
-            apl_{ apl } {}
+        // в response_executor собираются ответы на запросы, дождавшиеся снимка в потоке симуляции
+        Api(app::Application& apl, app::Simulation& sim, net::any_io_executor response_executor) :
+            apl_{ apl },
+            sim_{ sim },
+            response_executor_{ std::move(response_executor) },
+            maps_{ apl } {}
 
 
-        StringResponse GetStringResponse(const std::string& str, unsigned http_version);
+        // ответы по картам готовы заранее; при совпадении If-None-Match с ETag - 304 без тела
+        SharedOrStringResponse GetStringResponse(const std::string& str, std::string_view if_none_match, unsigned http_version,
+            BodyFormat format);
 
-        StringResponse GetUserResponse(const std::string& str, unsigned http_version) ;
+        // тело общее для всех запросов к одному снимку сессии
+        SharedOrStringResponse GetUserResponse(const std::string& str, unsigned http_version, BodyFormat format);
 
-        StringResponse GetStateResponse(const std::string& str, unsigned http_version);
+        // с параметром since=<tick> отдает только то, что изменилось начиная с этого тика;
+        // с wait=next запрос ждет следующего изменения сессии, пустое значение - ответ придет через reply
+        std::optional<SharedOrStringResponse> GetStateResponse(const std::string& str, const std::string& target,
+            unsigned http_version, BodyFormat format, const SharedReply& reply);
 
-        StringResponse PostUserAuthResponse(const std::string& str, unsigned http_version) ;
+        // пустое значение - запрос принят, ответ придет через reply
+        std::optional<StringResponse> PostUserAuthResponse(const std::string& str, unsigned http_version, const Reply& reply);
 
         StringResponse PostUserMoveResponse(const std::string& str, const std::string& auth, unsigned http_version) ;
 
-        StringResponse SetTickAndGetResponse(const std::string& str, unsigned http_version);
+        // пакет команд [{"token": .., "move": ..}, ..] от шлюза: одна команда в поток симуляции на весь пакет,
+        // в ответе статус каждого элемента в порядке запроса
+        StringResponse PostBatchMoveResponse(const std::string& str, unsigned http_version);
 
-        StringResponse GetRecordsResponse(const std::string& str, unsigned http_version);
+        std::optional<StringResponse> SetTickAndGetResponse(const std::string& str, unsigned http_version, const Reply& reply);
+
+        // одновременные запросы с одинаковыми start и maxItems ждут одного обращения к базе
+        SharedOrStringResponse GetRecordsResponse(const std::string& str, unsigned http_version);
+
+        // место лучшего результата игрока по имени из параметра name=, без обращения к базе
+        StringResponse GetRecordRankResponse(const std::string& str, unsigned http_version);
 
         /**
          * @brief Returns an error response.
@@ -52,6 +90,7 @@ namespace api_handler {
             std::string_view cache = NO_CACHE);
 
         
+        static BodyFormat GetBodyFormat(std::string_view accept);
         static bool TokenIsVadid(const std::string& str);
         static double GetMidleRange(double a, double b);
         static std::string URL_encode(const std::string& str);
@@ -61,16 +100,25 @@ namespace api_handler {
 
         static StringResponse GetTemplateResponse(unsigned http_version); 
 
-        const void PrintMaps(std::ostream& out) const ;
-        const void PrintMap(const model::Map* map, std::ostream& out) const;
-
-        const json::object PrintRoadAsJson(const model::Road& road) const;
-        const json::object PrintBuildingAsJson(const model::Building& build) const;
-        const json::object PrintOfficeAsJson(const model::Office& office) const;
+        template <typename Response>
+        static void SetBodyFormat(Response& response, BodyFormat format) {
+            response.set(http::field::content_type, format == BodyFormat::MsgPack ? CONT_TYPE_MSGPACK : CONT_TYPE_JSON);
+            // промежуточные кэши должны различать ответы по Accept
+            response.set(http::field::vary, "Accept");
+        }
 
-        std::string GetUserList(const std::string& token) const;
+        // значение параметра строки запроса; key вместе с '=' совпадает только с началом параметра,
+        // так что since= не найдется внутри, например, xsince=
+        static std::optional<std::string_view> FindQueryParam(std::string_view target, std::string_view key);
+        // пустое значение - параметра нет; false в second - значение некорректно
+        static std::pair<std::optional<std::uint64_t>, bool> GetSinceParam(const std::string& target);
+        // true в first - запрошен wait=next; false в second - значение некорректно
+        static std::pair<bool, bool> GetWaitParam(const std::string& target);
+        // курсор из afterScore, afterPlayTime (секунды, как в ответе) и afterName; нужны все три или ни одного
+        static std::pair<std::optional<db::RecordCursor>, bool> GetRecordCursorParam(const std::string& target);
 
-        std::string GetPlayersState(const std::string& token) const;
+        static SharedStringResponse MakeStateResponse(const app::SessionSnapshot& session, std::optional<std::uint64_t> since,
+            unsigned http_version, BodyFormat format);
 
         std::string GetAnswerUserAuthSuccess(const app::PlayerInfo& pi ) const ;
 
@@ -78,19 +126,25 @@ namespace api_handler {
 
         static std::pair< model::Speed, model::Direction> GetSpeedDirection(const std::string& dir, double spd);
 
-        void UpdateWorldState(int delta_time);
+        static bool MoveIsValid(const std::string& dir);
+
+        // отложенная отправка ответа из команды; команда с reply должна вернуть ее и при ошибке
+        static app::Simulation::Deferred DeferReply(const Reply& reply, StringResponse&& response);
 
         const std::string GetRecordTable(int offset, int max_elem);
 
     private:
         app::Application& apl_;
+        app::Simulation& sim_;
+        net::any_io_executor response_executor_;
+        const MapCatalogue maps_;
     };
 
 
     class ApiHandler {
     public:
-        ApiHandler(app::Application& apl)
-            : api_{ apl } {
+        ApiHandler(app::Application& apl, app::Simulation& sim, net::any_io_executor response_executor)
+            : api_{ apl, sim, std::move(response_executor) } {
         }
 
         static StringResponse GetErrorResponse(unsigned http_version, http::status status, std::string_view body,
@@ -99,50 +153,87 @@ namespace api_handler {
             return Api::GetErrorResponse(http_version, status, body, allow, allow_method, type, cache);
         }
 
-        template <typename Body>
-        StringResponse GetApiResponse(Body&& req) {
+        // send может быть вызван из потока симуляции, если ответ зависит от команды
+        template <typename Body, typename Send>
+        void HandleApiRequest(Body&& req, Send&& send) {
+            Api::Reply reply = [send](StringResponse&& response) {
+                send(std::move(response));
+            };
+            auto send_if_ready = [&send](std::optional<StringResponse>&& response) {
+                if (response) {
+                    send(std::move(*response));
+                }
+            };
+            Api::SharedReply shared_reply = [send](SharedOrStringResponse&& response) {
+                std::visit([&send](auto&& response) {
+                    send(std::move(response));
+                    }, std::move(response));
+            };
+
             auto version = req.version();
             std::string req_string = api_handler::Api::URL_encode(std::string(req.target()));
             auto authorization_header = req[http::field::authorization];
             std::string auth = std::string(authorization_header.data(), authorization_header.size());
             auto content_type = req[http::field::content_type];
             std::string type = std::string(content_type.data(), content_type.size());
+            auto if_none_match_header = req[http::field::if_none_match];
+            std::string if_none_match = std::string(if_none_match_header.data(), if_none_match_header.size());
+            auto accept = req[http::field::accept];
+            BodyFormat format = Api::GetBodyFormat(std::string_view(accept.data(), accept.size()));
             
             if (req_string.find(API_MAP) != std::string::npos) {
-                return TemplateResponse(req, API_MAPS_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD,  [this](const std::string& str, unsigned http_version) {
-                    return api_.GetStringResponse(str, http_version); }, req_string, version);
+                std::visit([&send](auto&& response) {
+                    send(std::move(response));
+                    }, TemplateResponse(req, API_MAPS_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this, format](const std::string& str, const std::string& if_none_match, unsigned http_version) {
+                    return api_.GetStringResponse(str, if_none_match, http_version, format); }, req_string, if_none_match, version));
             }
             else if (req_string.find(API_JOIN) != std::string::npos) {
-                return TemplateResponse(req, API_JOIN_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this](const std::string& str, unsigned http_version) {
-                    return api_.PostUserAuthResponse(str, http_version); }, req.body(), version);
+                send_if_ready(TemplateResponse(req, API_JOIN_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this, &reply](const std::string& str, unsigned http_version) {
+                    return api_.PostUserAuthResponse(str, http_version, reply); }, req.body(), version));
             }
             else if (req_string.find(API_PLAYERS) != std::string::npos) {
-                return TemplateResponse(req, API_PLAYERS_STATE_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this](const std::string& str, unsigned http_version) {
-                    return api_.GetUserResponse(str, http_version); }, auth, version);
+                shared_reply(TemplateResponse(req, API_PLAYERS_STATE_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this, format](const std::string& str, unsigned http_version) {
+                    return api_.GetUserResponse(str, http_version, format); }, auth, version));
             }
             else if (req_string.find(API_STATE) != std::string::npos) {
-                return TemplateResponse(req, API_PLAYERS_STATE_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this](const std::string& str, unsigned http_version) {
-                    return api_.GetStateResponse(str, http_version); }, auth, version);
+                auto response = TemplateResponse(req, API_PLAYERS_STATE_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this, format, &shared_reply](const std::string& str, const std::string& target, unsigned http_version) {
+                    return api_.GetStateResponse(str, target, http_version, format, shared_reply); }, auth, req_string, version);
+                if (response) {
+                    shared_reply(std::move(*response));
+                }
+            }
+            // путь пакета начинается с пути одиночной команды, поэтому проверяется раньше
+            else if (req_string.find(API_ACTION_BATCH) != std::string::npos) {
+                send(TemplateResponse(req, API_ACTION_BATCH_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this](const std::string& str, unsigned http_version) {
+                    return api_.PostBatchMoveResponse(str, http_version); }, req.body(), version));
             }
             else if (req_string.find(API_ACTION) != std::string::npos) {
-                return TemplateResponse(req, API_ACTION_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this](const std::string& str, const std::string& auth, unsigned http_version) {
-                    return api_.PostUserMoveResponse(str, auth, http_version); }, req.body(), auth, version);
+                send(TemplateResponse(req, API_ACTION_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this](const std::string& str, const std::string& auth, unsigned http_version) {
+                    return api_.PostUserMoveResponse(str, auth, http_version); }, req.body(), auth, version));
             }
             else if (req_string.find(API_TICK) != std::string::npos) {
-                return TemplateResponse(req, API_TICK_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this](const std::string& str, unsigned http_version) {
-                    return api_.SetTickAndGetResponse(str, http_version); }, req.body(), version);
+                send_if_ready(TemplateResponse(req, API_TICK_CHECK_PARAM, ERROR_PARAM_NOT_POST_METHOD, [this, &reply](const std::string& str, unsigned http_version) {
+                    return api_.SetTickAndGetResponse(str, http_version, reply); }, req.body(), version));
+            }
+            // путь места начинается с пути таблицы рекордов, поэтому проверяется раньше
+            else if (req_string.find(API_RECORD_RANK) != std::string::npos) {
+                send(TemplateResponse(req, API_MAPS_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this](const std::string& str, unsigned http_version) {
+                    return api_.GetRecordRankResponse(str, http_version); }, req_string, version));
             }
             else if (req_string.find(API_RECORDS) != std::string::npos) {
-                return TemplateResponse(req, API_MAPS_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this](const std::string& str, unsigned http_version) {
-                    return api_.GetRecordsResponse(str, http_version); }, std::string(req.target()), version);
+                shared_reply(TemplateResponse(req, API_MAPS_CHECK_PARAM, ERROR_PARAM_NOT_GET_HEAD_METHOD, [this](const std::string& str, unsigned http_version) {
+                    return api_.GetRecordsResponse(str, http_version); }, std::string(req.target()), version));
+            }
+            else {
+                send(api_.GetErrorResponse(version, http::status::bad_request, BAD_REQUEST));
             }
-            return api_.GetErrorResponse(version, http::status::bad_request, BAD_REQUEST);
         }
 
     private:
 
+        // возвращает то же, что action; ошибки проверки запроса приводятся к этому типу
         template <typename Body, typename Fn, typename... Args>
-        StringResponse TemplateResponse(Body&& req, const CheckParam& cp, const ErrorParam& ep, Fn action, Args&&... args) {
+        std::invoke_result_t<Fn, Args...> TemplateResponse(Body&& req, const CheckParam& cp, const ErrorParam& ep, Fn action, Args&&... args) {
             auto version = req.version();
 
             if (cp.allow_method2 != http::verb::delete_) {
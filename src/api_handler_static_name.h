@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include "http_server.h"
 
 namespace api_handler {
@@ -34,14 +35,40 @@ namespace api_handler {
     constexpr std::string_view POST_INVALID_METHOD = "{\n\t\"code\": \"invalidMethod\",\n\t\"message\": \"Invalid method, only POST method\"\n}";
     constexpr std::string_view GET_HEAD_INVALID_METHOD = "{\n\t\"code\": \"invalidMethod\",\n\t\"message\": \"Invalid method, only GET or HEAD method\"\n}";
     constexpr std::string_view INVALID_CONTENT = "{\n\t\"code\": \"invalidArgument\",\n\t\"message\": \"Invalid content type\"\n}";
+    constexpr std::string_view INVALID_SINCE = "{\n\t\"code\": \"invalidArgument\",\n\t\"message\": \"Invalid since tick\"\n}";
+    constexpr std::string_view RECORD_NOT_FOUND = "{\n\t\"code\": \"recordNotFound\",\n\t\"message\": \"Player record has not been found\"\n}";
+    constexpr std::string_view SERVER_ERROR = "{\n\t\"code\": \"internalError\",\n\t\"message\": \"Internal server error\"\n}";
+    constexpr std::string_view INVALID_WAIT = "{\n\t\"code\": \"invalidArgument\",\n\t\"message\": \"Invalid wait mode, only wait=next\"\n}";
+    constexpr std::string_view TOO_MANY_ACTIONS = "{\n\t\"code\": \"invalidArgument\",\n\t\"message\": \"Too many actions in batch\"\n}";
+
+    // коды в ответе на пакет команд, по одному на элемент запроса
+    constexpr std::string_view CODE_INVALID_TOKEN = "invalidToken";
+    constexpr std::string_view CODE_UNKNOWN_TOKEN = "unknownToken";
+    constexpr std::string_view CODE_INVALID_ARGUMENT = "invalidArgument";
+    constexpr size_t MAX_ACTION_BATCH = 1024;
+
+    // номер тика, после которого снят снимок в ответе
+    constexpr std::string_view GAME_TICK_HEADER = "X-Game-Tick";
+    // полный снимок или только изменения с тика since
+    constexpr std::string_view GAME_STATE_HEADER = "X-Game-State";
+    constexpr std::string_view GAME_STATE_FULL = "full";
+    constexpr std::string_view GAME_STATE_DELTA = "delta";
+    constexpr std::string_view SINCE_STR = "since=";
+    // long-poll: ответ придет со следующим тиком сессии или по таймауту с текущим снимком
+    constexpr std::string_view WAIT_STR = "wait=";
+    constexpr std::string_view WAIT_NEXT = "next";
+    constexpr std::chrono::milliseconds LONG_POLL_TIMEOUT{ 25000 };
 
     constexpr std::string_view API_MAP = "/api/v1/maps";
     constexpr std::string_view API_JOIN = "/api/v1/game/join";
     constexpr std::string_view API_PLAYERS = "/api/v1/game/players";
     constexpr std::string_view API_STATE = "/api/v1/game/state";
     constexpr std::string_view API_ACTION = "/api/v1/game/player/action";
+    constexpr std::string_view API_ACTION_BATCH = "/api/v1/game/player/actions";
     constexpr std::string_view API_TICK = "/api/v1/game/tick";
     constexpr std::string_view API_RECORDS = "api/v1/game/records";
+    constexpr std::string_view API_RECORD_RANK = "api/v1/game/records/rank";
+    constexpr std::string_view NAME_PARAM_STR = "name=";
 
     constexpr std::string_view ALLOW_METHOD_GET_HEAD = "GET, HEAD";
     constexpr std::string_view ALLOW_METHOD_POST = "POST";
@@ -50,6 +77,8 @@ namespace api_handler {
     constexpr int TOKEN_PREFIX_SIZE = 7;
 
     constexpr std::string_view CONT_TYPE_JSON = "application/json";
+    constexpr std::string_view CONT_TYPE_MSGPACK = "application/msgpack";
+    constexpr std::string_view CONT_TYPE_X_MSGPACK = "application/x-msgpack";
     constexpr std::string_view NO_CACHE = "no-cache";
 
     constexpr std::string_view ID_STR = "id";
@@ -65,6 +94,8 @@ namespace api_handler {
     constexpr std::string_view X1_STR = "x1";
     constexpr std::string_view Y1_STR = "y1";
     constexpr std::string_view EMPTY_STR = "";
+    constexpr std::string_view TOKEN_STR = "token";
+    constexpr std::string_view MOVE_STR = "move";
 
     constexpr http::status METHOD_NOT_ALLOWED = http::status::method_not_allowed;
     constexpr http::status METHOD_UNAUTHIRIZED = http::status::unauthorized;
@@ -92,6 +123,8 @@ namespace api_handler {
     constexpr CheckParam API_ACTION_CHECK_PARAM{ .allow_method1 = POST_METHOD, .allow_method2 = NULL_METHOD, 
         .auth_header = true, .cont_type = true, .cont_name = CONT_TYPE_JSON, .ah = ERROR_PARAM_BAD_AUTHORIZE, 
         .ct = ERROR_PARAM_WRONG_CONTENT_TYPE };
+    constexpr CheckParam API_ACTION_BATCH_CHECK_PARAM{ .allow_method1 = POST_METHOD, .allow_method2 = NULL_METHOD, 
+        .auth_header = false, .cont_type = true, .cont_name = CONT_TYPE_JSON, .ah = {}, .ct = ERROR_PARAM_WRONG_CONTENT_TYPE };
     constexpr CheckParam API_TICK_CHECK_PARAM{ .allow_method1 = POST_METHOD, .allow_method2 = NULL_METHOD, 
         .auth_header = false, .cont_type = false, .cont_name = CONT_TYPE_JSON, .ah = {}, .ct = ERROR_PARAM_WRONG_CONTENT_TYPE };
 
@@ -1,3 +1,4 @@
+#include <cmath>
 #include "app.h"
 
 namespace app {
@@ -43,10 +44,14 @@ namespace app {
 
         model::GameSession* session = game_->AddSession(dog, *map);
 
-        const model::Dog* dog_ptr = session->GetLastDog();
+        model::Dog* dog_ptr = session->GetLastDog();
 
         app::Player player = players_->AddPlayer(dog_ptr, session);
         player_tokens_.insert(player.GetToken());
+        AssignSessionPhase(session);
+        TrackDog(*session, dog_ptr);
+        MarkSessionChanged(*session);
+        ++players_version_;
 
         return { player.GetToken(), player.GetId() };
     }
@@ -82,11 +87,43 @@ namespace app {
     }
 
     void Application::UpdateWorldState(size_t delta_time) {
-        
-        for (auto& session : game_->GetSessions()) {
-            UpdateSessionState(*session, delta_time);
+        UpdateWorldPhase(delta_time, 0, 1);
+    }
+
+    void Application::UpdateWorldPhase(size_t delta_time, size_t phase, size_t phases) {
+        // сессия обновляется в фазе, равной ее порядковому номеру по модулю числа фаз
+        std::vector<std::shared_ptr<model::GameSession>> sessions = game_->GetSessions();
+        if (phases > 1) {
+            std::erase_if(sessions, [this, phase, phases](const std::shared_ptr<model::GameSession>& session) {
+                return session_phases_.at(session.get()) % phases != phase;
+            });
+        }
+
+        // тик и мировое время идут один раз за период: он начинается в фазе 0,
+        // сессии остальных фаз проходят тот же шаг позже в этом же периоде
+        if (phase == 0) {
+            ++tick_;
+            world_time_ += delta_time;
+        }
+
+        if (tick_pool_) {
+            UpdateSessionsParallel(sessions, delta_time);
+        }
+        else {
+            for (auto& session : sessions) {
+                UpdateSessionState(*session, delta_time);
+            }
+        }
+        for (const auto& session : sessions) {
+            MarkSessionChanged(*session);
         }
 
+        // общие для мира шаги выполняются в последней фазе периода, когда все сессии дошли до мирового времени
+        if (phase + 1 != phases) {
+            return;
+        }
+
+        ExpireIdleDogs();
         SendDogToRetirement();
 
         if (!saved_file_.empty()) {
@@ -105,85 +142,288 @@ namespace app {
         }
     }
 
+    std::uint64_t Application::GetTick() const {
+        return tick_;
+    }
+
+    std::vector<std::shared_ptr<model::GameSession>> Application::GetSessions() const {
+        return game_->GetSessions();
+    }
+
+    std::vector<const model::GameSession*> Application::TakeChangedSessions() {
+        std::vector<const model::GameSession*> changed(changed_sessions_.begin(), changed_sessions_.end());
+        changed_sessions_.clear();
+        return changed;
+    }
+
+    void Application::MarkSessionChanged(const model::GameSession& session) {
+        changed_sessions_.insert(&session);
+    }
+
+    std::unique_ptr<SessionSnapshot> Application::MakeSessionSnapshot(const model::GameSession& session) const {
+        auto snapshot = std::make_unique<SessionSnapshot>();
+        snapshot->tick = tick_;
+
+        snapshot->players.reserve(session.GetDogs().size());
+        for (const auto& [dog_id, dog] : session.GetDogs()) {
+            const Player* player = players_->FindByDogPtr(dog);
+            snapshot->players.push_back({ player->GetId(), player->GetName(), dog->GetPosition(), dog->GetSpeed(),
+                dog->GetDirection(), dog->GetItemFromBag(), dog->GetScore(), dog->GetRevision() });
+        }
+        std::sort(snapshot->players.begin(), snapshot->players.end(), [](const PlayerSnapshot& l, const PlayerSnapshot& r) {
+            return l.id < r.id;
+        });
+
+        snapshot->loot.reserve(session.GetTrophyList().size());
+        for (const auto& [id, trophy] : session.GetTrophyList()) {
+            snapshot->loot.push_back({ id, trophy });
+        }
+
+        return snapshot;
+    }
+
+    std::uint64_t Application::GetPlayersVersion() const {
+        return players_version_;
+    }
+
     bool Application::isSelfMode() const {
         return self_update_;
     }
 
-    const json::array Application::GetTrophies(const std::string& map_id) const {
+    const json::array& Application::GetTrophies(const std::string& map_id) const {
         return tl_.GetTrophy(map_id);
     }
 
+    void Application::UpdateSessionsParallel(const std::vector<std::shared_ptr<model::GameSession>>& sessions, size_t delta_time) {
+        if (event_sim_) {
+            // состояния сессий создаются заранее, чтобы воркеры не меняли общую таблицу
+            for (auto& session : sessions) {
+                event_sim_->AttachSession(*session, GetOfficeColliders(session->GetMap()));
+            }
+        }
+
+        // большие сессии по очереди занимают весь пул, остальные распределяются по воркерам целиком
+        std::vector<model::GameSession*> whole_sessions;
+        whole_sessions.reserve(sessions.size());
+        for (auto& session : sessions) {
+            if (IsSplitSession(*session)) {
+                CalcCollisionDogsAndTrophySplit(*session, delta_time, collision_buffers_.front());
+            }
+            else {
+                whole_sessions.push_back(session.get());
+            }
+        }
+
+        // движение и столкновения затрагивают только свою сессию
+        tick_pool_->Run(whole_sessions.size(), [&](size_t worker, size_t index) {
+            UpdateSessionMovement(*whole_sessions[index], delta_time, collision_buffers_[worker]);
+        });
+
+        // генератор трофеев общий для всех сессий, поэтому трофеи появляются после барьера
+        // в том же порядке сессий, что и при последовательном обновлении
+        for (auto& session : sessions) {
+            UpdateTrophyState(*session, delta_time);
+        }
+    }
+
     void Application::UpdateSessionState(model::GameSession& session, size_t delta_time) {
-        CalcCollisionDogsAndTrophy(session, delta_time);
+        UpdateSessionMovement(session, delta_time, collision_buffers_.front());
         UpdateTrophyState(session, delta_time);
     }
 
-    void Application::CalcCollisionDogsAndTrophy(model::GameSession& session, size_t delta_time) {
+    void Application::UpdateSessionMovement(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers) {
+        if (event_sim_) {
+            event_sim_->Advance(session, delta_time, GetOfficeColliders(session.GetMap()));
+        }
+        else {
+            CalcCollisionDogsAndTrophy(session, delta_time, buffers);
+        }
+    }
+
+    void Application::ChangeDogMovement(const std::string& token, const std::optional<std::pair<model::Speed, model::Direction>>& move) {
+        Player* player = GetPlayerByToken(token);
+        model::Dog* dog = player->GetDog();
+        model::GameSession& session = GetPlayerSession(*player);
+
+        // время простоя копится только у стоящей собаки, поэтому досчитываем его до смены скорости
+        SyncDogTime(dog);
+
+        if (!move) {
+            dog->SetSpeed(model::ZEROSPEED);
+        }
+        else {
+            dog->EraseStayTime();
+            dog->SetSpeed(move->first);
+            dog->SetDirection(move->second);
+        }
+
+        UpdateDogActivity(session, dog);
+        MarkSessionChanged(session);
 
-        std::vector<collision_detector::Gatherer> vec_gath = GetGathererList(session, delta_time);
-        std::vector<collision_detector::Item> vec_items = GetTrophyList(session);
-        std::vector<collision_detector::Office> vec_office = GetOfficeList(session);
+        if (event_sim_) {
+            event_sim_->OnDogMovementChanged(session, dog, GetOfficeColliders(session.GetMap()));
+        }
+    }
 
-        collision_detector::TrophyProvider tp{ vec_items, vec_gath, vec_office };
-        auto events = collision_detector::FindGatherEvents(tp);
+    model::GameSession& Application::GetPlayerSession(const Player& player) {
+        return *game_->GetSession(*player.GetSession()->GetMap()->GetId());
+    }
 
-        UpdateSessionForCollectAndReturnTrophy(session, events);
+    void Application::AssignSessionPhase(const model::GameSession* session) {
+        // AddSession возвращает и уже существующую сессию карты, ее номер не меняется
+        session_phases_.try_emplace(session, session_phases_.size());
     }
 
-    std::vector<collision_detector::Gatherer> Application::GetGathererList(model::GameSession& session, size_t delta_time) {
-        std::vector<collision_detector::Gatherer> vec_gath;
-        vec_gath.reserve(session.GetDogs().size());
-        for (const auto dog : session.GetDogs()) {
-            model::Position old_position = dog.second->GetPosition();
-            auto player_token = players_->FindByDogPtr(dog.second)->GetToken();
-            model::Position new_position = UpdatePlayerState(player_token, delta_time);
-            vec_gath.push_back({ player_token, { old_position.x_pos, old_position.y_pos },
-                               { new_position.x_pos, new_position.y_pos }, collision_detector::DOG_COLLIDER_SIZE});
+    void Application::TrackDog(model::GameSession& session, model::Dog* dog) {
+        dog_clocks_[dog] = { world_time_, 0 };
+        UpdateDogActivity(session, dog);
+    }
+
+    void Application::SyncDogTime(model::Dog* dog) {
+        DogClock& clock = dog_clocks_.at(dog);
+        const std::uint64_t elapsed = world_time_ - clock.synced_at;
+        if (elapsed == 0) {
+            return;
         }
-        return vec_gath;
+        dog->UpdatePlayedTime(static_cast<double>(elapsed));
+        if (dog->GetSpeed() == model::ZEROSPEED) {
+            dog->UpdateStayTime(static_cast<double>(elapsed));
+        }
+        clock.synced_at = world_time_;
     }
 
-    std::vector<collision_detector::Item> Application::GetTrophyList( model::GameSession& session)  {
-        std::vector <collision_detector::Item> vec_items;
-        vec_items.reserve(session.GetCountTrophyOnMap());
-        for (const auto& trophy : session.GetTrophyList()) {
-            collision_detector::Item item = { trophy.first, {trophy.second.GetPosition().x_pos, 
-                                        trophy.second.GetPosition().y_pos}, collision_detector::ITEM_COLLIDER_SIZE };
-            vec_items.push_back(item);
+    void Application::UpdateDogActivity(model::GameSession& session, model::Dog* dog) {
+        DogClock& clock = dog_clocks_.at(dog);
+        // прежняя запись в колесе становится устаревшей
+        clock.generation = next_dog_generation_++;
+
+        if (dog->GetSpeed() != model::ZEROSPEED) {
+            session.SetDogActive(dog, true);
+            return;
         }
-        return vec_items;
+
+        session.SetDogActive(dog, false);
+        const double time_left = std::max(0.0, std::ceil(game_->GetRetirementTime() - dog->GetStayTime()));
+        retirement_wheel_.Schedule(world_time_ + static_cast<std::uint64_t>(time_left), { dog, clock.generation });
     }
 
-    std::vector<collision_detector::Office> Application::GetOfficeList( model::GameSession& session)  {
-        std::vector<collision_detector::Office> vec_office;
-        vec_office.reserve(session.GetMap()->GetOffices().size());
-        for (const auto& office : session.GetMap()->GetOffices()) {
-            collision_detector::Office ofc = { *office.GetId(), {static_cast<double>(office.GetPosition().x),
-                                        static_cast<double>(office.GetPosition().y)}, collision_detector::OFFICE_COLLIDER_SIZE };
-            vec_office.push_back(ofc);
+    void Application::ExpireIdleDogs() {
+        retirement_wheel_.Advance(world_time_, [this](const IdleDog& idle) {
+            auto it = dog_clocks_.find(idle.dog);
+            if (it == dog_clocks_.end() || it->second.generation != idle.generation) {
+                return;
+            }
+            SyncDogTime(idle.dog);
+            to_retirement.push_back(players_->FindByDogPtr(idle.dog)->GetToken());
+        });
+    }
+
+    void Application::CalcCollisionDogsAndTrophy(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers) {
+        FillGathererList(session, delta_time, buffers);
+        FillTrophyList(session, buffers.items);
+
+        collision_detector::SpanProvider provider{ buffers.items, buffers.gatherers, GetOfficeColliders(session.GetMap()) };
+        collision_detector::FindGatherEvents(provider, buffers.events);
+
+        UpdateSessionForCollectAndReturnTrophy(session, buffers.dogs, buffers.events);
+    }
+
+    bool Application::IsSplitSession(model::GameSession& session) const {
+        return split_sessions_ && tick_pool_ && !event_sim_ && session.GetActiveDogs().size() >= SPLIT_SESSION_MIN_DOGS;
+    }
+
+    void Application::CalcCollisionDogsAndTrophySplit(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers) {
+        buffers.dogs.clear();
+        for (const auto& [id, dog] : session.GetActiveDogs()) {
+            buffers.dogs.push_back(dog);
+        }
+
+        // собаки двигаются независимо друг от друга, каждый блок пишет только свои элементы
+        const size_t dogs_count = buffers.dogs.size();
+        buffers.gatherers.resize(dogs_count);
+        const size_t chunks = (dogs_count + MOVEMENT_CHUNK_SIZE - 1) / MOVEMENT_CHUNK_SIZE;
+        tick_pool_->Run(chunks, [&](size_t, size_t chunk) {
+            const size_t end = std::min(dogs_count, (chunk + 1) * MOVEMENT_CHUNK_SIZE);
+            for (size_t i = chunk * MOVEMENT_CHUNK_SIZE; i < end; ++i) {
+                model::Dog* dog = buffers.dogs[i];
+                model::Position old_position = dog->GetPosition();
+                model::Position new_position = UpdatePlayerState(session, dog, delta_time);
+                buffers.gatherers[i] = { { old_position.x_pos, old_position.y_pos },
+                               { new_position.x_pos, new_position.y_pos }, collision_detector::DOG_COLLIDER_SIZE };
+            }
+        });
+
+        for (size_t i = 0; i < dogs_count; ++i) {
+            if (collision_detector::IsPointEquals(buffers.gatherers[i].start_pos, buffers.gatherers[i].end_pos)) {
+                session.SetDogActive(buffers.dogs[i], false);
+            }
         }
-        return vec_office;
+
+        FillTrophyList(session, buffers.items);
+
+        collision_detector::SpanProvider provider{ buffers.items, buffers.gatherers, GetOfficeColliders(session.GetMap()) };
+        collision_detector::FindGatherEventsParallel(provider, *tick_pool_, buffers.parallel, buffers.events);
+
+        // события применяются последовательно в порядке времени, как и без разбиения
+        UpdateSessionForCollectAndReturnTrophy(session, buffers.dogs, buffers.events);
     }
 
-    model::Position Application::UpdatePlayerState(const Token& token, size_t delta_time) {
-        model::Dog* dog = players_->FindByToken(token)->GetDog();
-        dog->UpdatePlayedTime(delta_time);
+    void Application::FillGathererList(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers) {
+        buffers.dogs.clear();
+        buffers.gatherers.clear();
+        buffers.stuck.clear();
+        buffers.dogs.reserve(session.GetActiveDogs().size());
+        buffers.gatherers.reserve(session.GetActiveDogs().size());
+        for (const auto& [id, dog] : session.GetActiveDogs()) {
+            model::Position old_position = dog->GetPosition();
+            model::Position new_position = UpdatePlayerState(session, dog, delta_time);
+            buffers.dogs.push_back(dog);
+            buffers.gatherers.push_back({ { old_position.x_pos, old_position.y_pos },
+                               { new_position.x_pos, new_position.y_pos }, collision_detector::DOG_COLLIDER_SIZE });
+            if (new_position == old_position) {
+                buffers.stuck.push_back(dog);
+            }
+        }
 
-        if (dog->GetSpeed() != model::ZEROSPEED) {
-            std::vector<const model::Road*> roads = players_->FindByToken(token)->GetSession()->GetMap()->GetRoadAtPoint(dog->GetPosition());
-            std::pair<model::Position, bool> path_info = GetDogNewPosition(roads, dog, delta_time);
-            MoveDogToNewPosiotion(dog, path_info.first, path_info.second);
-            return path_info.first;
+        // собака уперлась в край дороги и до смены направления никуда не сдвинется
+        for (const model::Dog* dog : buffers.stuck) {
+            session.SetDogActive(dog, false);
         }
-        else {
-            dog->UpdateStayTime(delta_time);
-            if (dog->GetStayTime() >= game_->GetRetirementTime()) {
-                to_retirement.push_back(token);
+    }
+
+    void Application::FillTrophyList(const model::GameSession& session, std::vector<collision_detector::Item>& items) {
+        items.clear();
+        items.reserve(session.GetCountTrophyOnMap());
+        for (const auto& trophy : session.GetTrophyList()) {
+            items.push_back({ trophy.first, {trophy.second.GetPosition().x_pos,
+                                        trophy.second.GetPosition().y_pos}, collision_detector::ITEM_COLLIDER_SIZE });
+        }
+    }
+
+    void Application::BuildOfficeColliders() {
+        for (const auto& map : game_->GetMaps()) {
+            const auto& map_offices = map.GetOffices();
+            std::vector<collision_detector::Item> offices;
+            offices.reserve(map_offices.size());
+            for (size_t i = 0; i < map_offices.size(); ++i) {
+                offices.push_back({ i, {static_cast<double>(map_offices[i].GetPosition().x),
+                                        static_cast<double>(map_offices[i].GetPosition().y)}, collision_detector::OFFICE_COLLIDER_SIZE });
             }
-            return dog->GetPosition();
+            office_colliders_.emplace(&map, collision_detector::StaticColliders(std::move(offices), collision_detector::DOG_COLLIDER_SIZE));
         }
     }
 
+    const collision_detector::StaticColliders& Application::GetOfficeColliders(const model::Map* map) const {
+        return office_colliders_.at(map);
+    }
+
+    model::Position Application::UpdatePlayerState(const model::GameSession& session, model::Dog* dog, size_t delta_time) {
+        std::vector<const model::Road*> roads = session.GetMap()->GetRoadAtPoint(dog->GetPosition());
+        std::pair<model::Position, bool> path_info = GetDogNewPosition(roads, dog, delta_time);
+        MoveDogToNewPosiotion(dog, path_info.first, path_info.second);
+        return path_info.first;
+    }
+
     std::pair<model::Position, bool> Application::GetDogNewPosition(const std::vector<const model::Road*>& roads, const model::Dog* dog, size_t delta_time) {
         model::Position dog_pos = dog->GetPosition();
         model::Position new_pos;
@@ -214,19 +454,19 @@ namespace app {
         }
     }
 
-    void Application::UpdateSessionForCollectAndReturnTrophy(model::GameSession& session,
-        const std::vector<collision_detector::GatheringEvent>& ge) {
+    void Application::UpdateSessionForCollectAndReturnTrophy(model::GameSession& session, const std::vector<model::Dog*>& dogs,
+        const std::vector<collision_detector::IndexedGatheringEvent>& ge) {
         std::unordered_set<size_t> collected_trophy;
         for (const auto& event : ge) {
             if (event.is_office == false && !collected_trophy.count(event.item_id)) {
-                model::Dog* dog = GetPlayerByToken(*event.gatherer_token)->GetDog();
+                model::Dog* dog = dogs[event.gatherer_idx];
                 if (dog->HasMoreCapacity()) {
                     dog->AddItemToBag(session.GetTrophy(event.item_id));
                     collected_trophy.emplace(event.item_id);
                 }
             }
             if (event.is_office == true) {
-                model::Dog* dog = GetPlayerByToken(*event.gatherer_token)->GetDog();
+                model::Dog* dog = dogs[event.gatherer_idx];
                 dog->ReturnTrophyToOffice();
             }
         }
@@ -256,6 +496,9 @@ namespace app {
                     int trophy_type = GetRandonValueInt(0, session.GetMap()->GetNumberTrophyTypes() - 1);
                     model::Trophy trophy(session.GetCountTrophyAdded(), trophy_type, trophy_position);
                     session.AddTrophyOnMap(trophy);
+                    if (event_sim_) {
+                        event_sim_->OnTrophyAdded(session, trophy);
+                    }
                 }
             }
         }
@@ -305,10 +548,14 @@ namespace app {
             const model::Map* map = game_->GetMap(player.GetMapId());
             model::GameSession* session = game_->AddSession(dog, *map);
 
-            const model::Dog* dog_ptr = session->GetLastDog();
+            model::Dog* dog_ptr = session->GetLastDog();
 
             app::Player real_player = players_->AddPlayer(dog_ptr, session, player.GetToken());
             player_tokens_.insert(player.GetToken());
+            AssignSessionPhase(session);
+            TrackDog(*session, dog_ptr);
+            MarkSessionChanged(*session);
+            ++players_version_;
 
         }
 
@@ -316,7 +563,9 @@ namespace app {
             if (map_with_players.count(trophy.GetMapID())) {
 
                 model::Trophy real_trophy(trophy.GetId(), trophy.GetType(), trophy.GetPos());
-                game_->GetSession(trophy.GetMapID())->AddTrophyOnMap(real_trophy);
+                model::GameSession* session = game_->GetSession(trophy.GetMapID());
+                session->AddTrophyOnMap(real_trophy);
+                MarkSessionChanged(*session);
             }
         }
 
@@ -334,7 +583,10 @@ namespace app {
 
     void Application::SaveDogRecord(const Token& token) {
         model::Dog* dog = players_->FindByToken(token)->GetDog();
-        db_.WriteToBD({ dog->GetName(), dog->GetScore(), dog->GetPlayedTime() });
+        // тик не ждет базу: запись уходит в очередь, таблица рекордов в памяти обновляется сразу
+        record_writer_.Enqueue({ dog->GetName(), dog->GetScore(), dog->GetPlayedTime() });
+        // в integer-колонку базы время попадает с округлением к ближайшему
+        leaderboard_.Add(dog->GetName(), dog->GetScore(), std::llrint(dog->GetPlayedTime()));
     }
 
     void Application::DeleteDog(const Token& token) {
@@ -342,15 +594,34 @@ namespace app {
 
         Player* pl = GetPlayerByToken(*token);
 
-        for (auto& session : game_->GetSessions()) {
-            session->DeleteDog(pl->GetDog());
+        if (event_sim_) {
+            event_sim_->OnDogRemoved(*pl->GetSession(), pl->GetDog());
         }
 
+        // собака есть только в сессии своего игрока
+        model::GameSession& session = GetPlayerSession(*pl);
+        session.DeleteDog(pl->GetDog());
+        MarkSessionChanged(session);
+        dog_clocks_.erase(pl->GetDog());
+
         players_->DeletePlayer(*token);
+        ++players_version_;
 
     }
     
     const std::vector<db::GameRecords> Application::GetRecords(int offset, int max_elem) {
-        return db_.GetRecords(offset, max_elem);
+        return leaderboard_.GetPage(offset, max_elem);
+    }
+
+    const std::vector<db::GameRecords> Application::GetRecordsAfter(const db::RecordCursor& cursor, int max_elem) {
+        return leaderboard_.GetPageAfter(cursor, max_elem);
+    }
+
+    db::RecordWriter& Application::GetRecordWriter() {
+        return record_writer_;
+    }
+
+    std::optional<db::Leaderboard::Rank> Application::FindRecordRank(const std::string& name) const {
+        return leaderboard_.FindRank(name);
     }
 }
\ No newline at end of file
@@ -2,9 +2,16 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <optional>
 #include "app_addition_struct.h"
-#include "database.h"
+#include "event_simulation.h"
+#include "leaderboard.h"
+#include "record_store.h"
+#include "record_writer.h"
 #include "serializator.h"
+#include "timer_wheel.h"
+#include "work_stealing_pool.h"
+#include "world_snapshot.h"
 
 namespace app {
     namespace json = boost::json;
@@ -19,8 +26,22 @@ namespace app {
             random_position_(conf.random_position),
             saved_file_(conf.saved_file),
             time_between_save_(conf.time_between_save),
-            db_({conf.db_url, db::MAX_DB_CONNECTION})
-        {}
+            split_sessions_(conf.split_sessions),
+            record_store_(db::MakeRecordStore(conf.db_url, conf.records_file))
+        {
+            if (conf.event_simulation) {
+                event_sim_ = std::make_unique<event_sim::EventSimulator>();
+            }
+            if (conf.tick_threads > 1) {
+                tick_pool_ = std::make_unique<util::WorkStealingPool>(conf.tick_threads);
+            }
+            collision_buffers_.resize(tick_pool_ ? tick_pool_->WorkersCount() : 1);
+            BuildOfficeColliders();
+            // таблица рекордов читается из хранилища один раз, дальше пополняется при уходе собак на пенсию
+            record_store_->ReadAllRecords([this](std::string name, std::uint64_t score, std::int64_t play_time_ms) {
+                leaderboard_.Add(name, score, play_time_ms);
+            });
+        }
 
         PlayerInfo JoinGame(const std::string& map_id, const std::string& name) ;
         bool HasToken(const std::string& token) const;
@@ -33,11 +54,31 @@ namespace app {
         static double GetRandonValueDouble(double a, double b);
         static int GetRandonValueInt(int a, int b);
         void UpdateWorldState(size_t delta_time);
+        // шаг одной фазы периода: обновляются только сессии этой фазы
+        void UpdateWorldPhase(size_t delta_time, size_t phase, size_t phases);
+        // число начатых периодов обновления мира
+        std::uint64_t GetTick() const;
+        std::vector<std::shared_ptr<model::GameSession>> GetSessions() const;
+        // сессии, измененные тиком или командами после прошлого вызова; снимки нужны только им
+        std::vector<const model::GameSession*> TakeChangedSessions();
+        // копия состояния сессии для обработчиков чтения, version заполняет вызывающий
+        std::unique_ptr<SessionSnapshot> MakeSessionSnapshot(const model::GameSession& session) const;
+        // меняется при входе и уходе игроков
+        std::uint64_t GetPlayersVersion() const;
+        // меняет скорость и направление собаки игрока, пустое значение останавливает собаку
+        void ChangeDogMovement(const std::string& token, const std::optional<std::pair<model::Speed, model::Direction>>& move);
         bool isSelfMode() const;
-        const json::array GetTrophies(const std::string& map_id) const;
+        const json::array& GetTrophies(const std::string& map_id) const;
         void UploadGameState();
         void SaveGameState();
+        // страница таблицы рекордов из памяти, имена при равных очках и времени идут побайтно
         const std::vector<db::GameRecords> GetRecords(int offset, int max_elem);
+        // страница после записи cursor, глубина страницы не влияет на время
+        const std::vector<db::GameRecords> GetRecordsAfter(const db::RecordCursor& cursor, int max_elem);
+        // рекорды уходят в базу в фоне пачками; статистика и остановка с дописыванием очереди
+        db::RecordWriter& GetRecordWriter();
+        // место лучшего результата игрока с этим именем; можно вызывать из любого потока
+        std::optional<db::Leaderboard::Rank> FindRecordRank(const std::string& name) const;
 
     public:
         enum JoinPlayerErrorCode {
@@ -52,15 +93,56 @@ namespace app {
             }
         };
         
+        // буферы расчета столкновений, переиспользуются между тиками
+        struct CollisionBuffers {
+            std::vector<model::Dog*> dogs;
+            std::vector<collision_detector::IndexedGatherer> gatherers;
+            std::vector<collision_detector::Item> items;
+            std::vector<collision_detector::IndexedGatheringEvent> events;
+            std::vector<const model::Dog*> stuck;
+            collision_detector::ParallelGatherBuffers parallel;
+        };
+
+        // момент мирового времени, до которого досчитаны игровое время и время простоя собаки
+        struct DogClock {
+            std::uint64_t synced_at;
+            std::uint64_t generation;
+        };
+
+        struct IdleDog {
+            model::Dog* dog;
+            std::uint64_t generation;
+        };
+
+        static constexpr std::uint64_t RETIREMENT_WHEEL_GRANULARITY = 16;
+        static constexpr size_t RETIREMENT_WHEEL_SLOTS = 4096;
+
+        // сессии с таким числом движущихся собак обновляются на всех потоках пула
+        static constexpr size_t SPLIT_SESSION_MIN_DOGS = 4096;
+        static constexpr size_t MOVEMENT_CHUNK_SIZE = 1024;
+
+        void UpdateSessionsParallel(const std::vector<std::shared_ptr<model::GameSession>>& sessions, size_t delta_time);
         void UpdateSessionState(model::GameSession& session, size_t delta_time);
-        void CalcCollisionDogsAndTrophy(model::GameSession& session, size_t delta_time);
+        void UpdateSessionMovement(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers);
+        void CalcCollisionDogsAndTrophy(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers);
+        bool IsSplitSession(model::GameSession& session) const;
+        void CalcCollisionDogsAndTrophySplit(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers);
 
-        std::vector<collision_detector::Gatherer> GetGathererList(model::GameSession& session, size_t delta_time);
-        std::vector<collision_detector::Item> GetTrophyList(model::GameSession& session);
-        std::vector<collision_detector::Office> GetOfficeList(model::GameSession& session);
-        model::Position UpdatePlayerState(const Token& token, size_t delta_time);
+        void FillGathererList(model::GameSession& session, size_t delta_time, CollisionBuffers& buffers);
+        void FillTrophyList(const model::GameSession& session, std::vector<collision_detector::Item>& items);
+        void BuildOfficeColliders();
+        const collision_detector::StaticColliders& GetOfficeColliders(const model::Map* map) const;
+        model::Position UpdatePlayerState(const model::GameSession& session, model::Dog* dog, size_t delta_time);
+        model::GameSession& GetPlayerSession(const Player& player);
+        void AssignSessionPhase(const model::GameSession* session);
+        void MarkSessionChanged(const model::GameSession& session);
+        void TrackDog(model::GameSession& session, model::Dog* dog);
+        void SyncDogTime(model::Dog* dog);
+        void UpdateDogActivity(model::GameSession& session, model::Dog* dog);
+        void ExpireIdleDogs();
         
-        void UpdateSessionForCollectAndReturnTrophy(model::GameSession& session, const std::vector<collision_detector::GatheringEvent>& ge);
+        void UpdateSessionForCollectAndReturnTrophy(model::GameSession& session, const std::vector<model::Dog*>& dogs,
+            const std::vector<collision_detector::IndexedGatheringEvent>& ge);
 
         std::pair<model::Position, bool> GetDogNewPosition(const std::vector<const model::Road*>& roads, const model::Dog* dog, size_t delta_time);
         void MoveDogToNewPosiotion(model::Dog* dog, const model::Position& position, bool is_collised);
@@ -79,9 +161,32 @@ namespace app {
         std::unordered_set<Token, TokenHash> player_tokens_;
         std::string saved_file_;
         int time_between_save_;
-        db::Database db_;
+        bool split_sessions_;
+        // PostgreSQL или встроенный файл, см. AppConfig::records_file
+        std::unique_ptr<db::RecordStore> record_store_;
+        db::Leaderboard leaderboard_;
+        // объявлен после record_store_: поток записи останавливается раньше, чем закрывается хранилище
+        db::RecordWriter record_writer_{ [this](const std::vector<db::GameRecords>& batch) {
+            record_store_->WriteRecords(batch);
+        } };
         int current_time_ = 0;
         std::vector<Token> to_retirement;
+        // по набору буферов на воркер пула, без пула используется один
+        std::vector<CollisionBuffers> collision_buffers_;
+        // офисы неизменны после загрузки карт, коллайдеры строятся один раз на карту
+        std::unordered_map<const model::Map*, collision_detector::StaticColliders> office_colliders_;
+        std::unique_ptr<event_sim::EventSimulator> event_sim_;
+        std::unique_ptr<util::WorkStealingPool> tick_pool_;
+        // время собак досчитывается лениво, простаивающие ждут отправки на пенсию в колесе таймеров
+        std::uint64_t world_time_ = 0;
+        std::uint64_t tick_ = 0;
+        // порядковый номер сессии, назначается при ее создании; фаза - его остаток от деления на число фаз
+        std::unordered_map<const model::GameSession*, size_t> session_phases_;
+        std::unordered_set<const model::GameSession*> changed_sessions_;
+        std::uint64_t players_version_ = 0;
+        std::uint64_t next_dog_generation_ = 0;
+        std::unordered_map<const model::Dog*, DogClock> dog_clocks_;
+        util::TimerWheel<IdleDog> retirement_wheel_{ RETIREMENT_WHEEL_GRANULARITY, RETIREMENT_WHEEL_SLOTS };
     };
 
 }
\ No newline at end of file
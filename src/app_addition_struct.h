@@ -10,5 +10,10 @@ namespace app {
         std::string saved_file;
         int time_between_save;
         std::string db_url;
+        bool event_simulation = false;
+        unsigned tick_threads = 0;
+        bool split_sessions = false;
+        // непустой путь - рекорды во встроенном файле, db_url не нужен
+        std::string records_file;
     };
 }
\ No newline at end of file
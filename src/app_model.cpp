@@ -20,26 +20,20 @@ namespace app {
 
         std::shared_ptr<Player> p_ptr = std::make_shared<Player>(player_list_.back());
         players_table_[count_players] = p_ptr;
+        players_by_token_[*ptoken] = p_ptr.get();
+        players_by_dog_[dog] = p_ptr.get();
         ++count_players;
         return player_list_.back();
     }
 
     Player* Players::FindByToken(Token token) {
-        for (const auto& player : players_table_) {
-            if (player.second->GetToken() == token) {
-                return player.second.get();
-            }
-        }
-        return nullptr;
+        auto it = players_by_token_.find(*token);
+        return it == players_by_token_.end() ? nullptr : it->second;
     }
 
     Player* Players::FindByDogPtr(const model::Dog* dog) {
-        for (const auto& player : players_table_) {
-            if (player.second->GetDog() == dog) {
-                return player.second.get();
-            }
-        }
-        return nullptr;
+        auto it = players_by_dog_.find(dog);
+        return it == players_by_dog_.end() ? nullptr : it->second;
     }
 
     const std::map<int, std::shared_ptr<Player>>& Players::GetPlayersList() const {
@@ -51,14 +45,7 @@ namespace app {
     }
 
     bool Players::TokenAuthorized(const std::string& str) const {
-        Token token(str);
-
-        for (const auto& pl : players_table_) {
-            if (*pl.second->GetToken() == str) {
-                return true;
-            }
-        }
-        return false;
+        return players_by_token_.contains(str);
     }
 
     std::string Player::GetName() const {
@@ -80,16 +67,13 @@ namespace app {
     }
 
     void Players::DeletePlayer(const std::string& token) {
-        int id_to_erase = -1;
-        for (auto& player : players_table_) {
-            if (*player.second->GetToken() == token) {
-                id_to_erase = player.first;
-                break;
-            }
-        }
-        if (id_to_erase != -1) {
-            players_table_.erase(id_to_erase);
-
+        auto it = players_by_token_.find(token);
+        if (it == players_by_token_.end()) {
+            return;
         }
+        Player* player = it->second;
+        players_by_dog_.erase(player->GetDog());
+        players_by_token_.erase(it);
+        players_table_.erase(player->GetId());
     }
 }
\ No newline at end of file
@@ -77,6 +77,9 @@ namespace app {
     private:
         std::list<Player> player_list_;
         std::map<int, std::shared_ptr<Player>> players_table_;
+        // индексы для поиска без перебора всех игроков
+        std::unordered_map<std::string, Player*> players_by_token_;
+        std::unordered_map<const model::Dog*, Player*> players_by_dog_;
 
         unsigned int count_players = 0;
     };
@@ -1,9 +1,17 @@
 #include <cassert>
 #include "collision_detector.h"
+#include "work_stealing_pool.h"
 #include <iostream>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace collision_detector {
 
+// запас на погрешность вычислений, чтобы точка на границе радиуса не выпала из выборки
+const double GRID_QUERY_EPSILON = 1e-9;
+
 CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
 
     assert(b.x != a.x || b.y != a.y);
@@ -20,7 +28,377 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
     return CollectionResult(sq_distance, proj_ratio);
 }
 
+void SpatialGrid::Insert(size_t idx, geom::Point2D pos) {
+    const std::int64_t cx = ToCell(pos.x);
+    const std::int64_t cy = ToCell(pos.y);
+    auto [it, inserted] = cells_.try_emplace(MakeKey(cx, cy), Cell{ cx, cy, {} });
+    it->second.indexes.push_back(idx);
+    ++count_;
+}
+
+void SpatialGrid::Remove(size_t idx, geom::Point2D pos) {
+    auto it = cells_.find(MakeKey(ToCell(pos.x), ToCell(pos.y)));
+    if (it == cells_.end()) {
+        return;
+    }
+    auto& indexes = it->second.indexes;
+    if (auto found = std::find(indexes.begin(), indexes.end(), idx); found != indexes.end()) {
+        *found = indexes.back();
+        indexes.pop_back();
+        --count_;
+    }
+    if (indexes.empty()) {
+        cells_.erase(it);
+    }
+}
+
+void SpatialGrid::Query(geom::Point2D a, geom::Point2D b, double radius, std::vector<size_t>& out) const {
+    out.clear();
+    if (cells_.empty()) {
+        return;
+    }
+
+    radius += GRID_QUERY_EPSILON;
+    const std::int64_t min_cx = ToCell(std::min(a.x, b.x) - radius);
+    const std::int64_t max_cx = ToCell(std::max(a.x, b.x) + radius);
+    const std::int64_t min_cy = ToCell(std::min(a.y, b.y) - radius);
+    const std::int64_t max_cy = ToCell(std::max(a.y, b.y) + radius);
+
+    const double range_cells = static_cast<double>(max_cx - min_cx + 1) * static_cast<double>(max_cy - min_cy + 1);
+
+    if (range_cells > static_cast<double>(cells_.size())) {
+        // отрезок накрывает больше ячеек, чем занято, дешевле пройти по занятым
+        for (const auto& [key, cell] : cells_) {
+            if (cell.cx >= min_cx && cell.cx <= max_cx && cell.cy >= min_cy && cell.cy <= max_cy) {
+                out.insert(out.end(), cell.indexes.begin(), cell.indexes.end());
+            }
+        }
+    }
+    else {
+        for (std::int64_t cx = min_cx; cx <= max_cx; ++cx) {
+            for (std::int64_t cy = min_cy; cy <= max_cy; ++cy) {
+                if (auto it = cells_.find(MakeKey(cx, cy)); it != cells_.end()) {
+                    out.insert(out.end(), it->second.indexes.begin(), it->second.indexes.end());
+                }
+            }
+        }
+    }
+
+    // каждый индекс лежит ровно в одной ячейке, достаточно восстановить порядок перебора
+    std::sort(out.begin(), out.end());
+}
+
+namespace {
+
+void TryCollectPointsScalar(double ax, double ay, double v_x, double v_y, double v_len2, double gatherer_width,
+    const PackedItems& items, size_t from, BatchCollectionResult& out) {
+    for (size_t i = from; i < items.Size(); ++i) {
+        const double u_x = items.x[i] - ax;
+        const double u_y = items.y[i] - ay;
+        const double u_dot_v = u_x * v_x + u_y * v_y;
+        const double u_len2 = u_x * u_x + u_y * u_y;
+        const double proj_ratio = u_dot_v / v_len2;
+        const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+        const double radius = gatherer_width + items.width[i];
+
+        out.proj_ratio[i] = proj_ratio;
+        out.sq_distance[i] = sq_distance;
+        out.hit_mask[i] = (proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= radius * radius) ? 1 : 0;
+    }
+}
+
+}  // namespace
+
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width,
+    const PackedItems& items, BatchCollectionResult& out) {
+    const size_t count = items.Size();
+    out.hit_mask.assign(count, 0);
+    out.sq_distance.resize(count);
+    out.proj_ratio.resize(count);
+
+    if (IsPointEquals(a, b)) {
+        std::fill(out.sq_distance.begin(), out.sq_distance.end(), 0.0);
+        std::fill(out.proj_ratio.begin(), out.proj_ratio.end(), 0.0);
+        return;
+    }
+
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+    size_t i = 0;
+
+    // порядок операций повторяет TryCollectPoint, чтобы результаты совпадали бит в бит
+#if defined(__AVX2__)
+    const __m256d ax4 = _mm256_set1_pd(a.x);
+    const __m256d ay4 = _mm256_set1_pd(a.y);
+    const __m256d vx4 = _mm256_set1_pd(v_x);
+    const __m256d vy4 = _mm256_set1_pd(v_y);
+    const __m256d vlen4 = _mm256_set1_pd(v_len2);
+    const __m256d gw4 = _mm256_set1_pd(gatherer_width);
+    const __m256d zero4 = _mm256_setzero_pd();
+    const __m256d one4 = _mm256_set1_pd(1.0);
+
+    for (; i + 4 <= count; i += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(&items.x[i]), ax4);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(&items.y[i]), ay4);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, vx4), _mm256_mul_pd(u_y, vy4));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_div_pd(u_dot_v, vlen4);
+        const __m256d sq_distance = _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), vlen4));
+        const __m256d radius = _mm256_add_pd(gw4, _mm256_loadu_pd(&items.width[i]));
+
+        const __m256d hit = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj_ratio, zero4, _CMP_GE_OQ), _mm256_cmp_pd(proj_ratio, one4, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_distance, _mm256_mul_pd(radius, radius), _CMP_LE_OQ));
+
+        _mm256_storeu_pd(&out.proj_ratio[i], proj_ratio);
+        _mm256_storeu_pd(&out.sq_distance[i], sq_distance);
+
+        const int mask = _mm256_movemask_pd(hit);
+        out.hit_mask[i] = mask & 1;
+        out.hit_mask[i + 1] = (mask >> 1) & 1;
+        out.hit_mask[i + 2] = (mask >> 2) & 1;
+        out.hit_mask[i + 3] = (mask >> 3) & 1;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128d ax2 = _mm_set1_pd(a.x);
+    const __m128d ay2 = _mm_set1_pd(a.y);
+    const __m128d vx2 = _mm_set1_pd(v_x);
+    const __m128d vy2 = _mm_set1_pd(v_y);
+    const __m128d vlen2 = _mm_set1_pd(v_len2);
+    const __m128d gw2 = _mm_set1_pd(gatherer_width);
+    const __m128d zero2 = _mm_setzero_pd();
+    const __m128d one2 = _mm_set1_pd(1.0);
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128d u_x = _mm_sub_pd(_mm_loadu_pd(&items.x[i]), ax2);
+        const __m128d u_y = _mm_sub_pd(_mm_loadu_pd(&items.y[i]), ay2);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(u_x, vx2), _mm_mul_pd(u_y, vy2));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(u_x, u_x), _mm_mul_pd(u_y, u_y));
+        const __m128d proj_ratio = _mm_div_pd(u_dot_v, vlen2);
+        const __m128d sq_distance = _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), vlen2));
+        const __m128d radius = _mm_add_pd(gw2, _mm_loadu_pd(&items.width[i]));
+
+        const __m128d hit = _mm_and_pd(
+            _mm_and_pd(_mm_cmpge_pd(proj_ratio, zero2), _mm_cmple_pd(proj_ratio, one2)),
+            _mm_cmple_pd(sq_distance, _mm_mul_pd(radius, radius)));
+
+        _mm_storeu_pd(&out.proj_ratio[i], proj_ratio);
+        _mm_storeu_pd(&out.sq_distance[i], sq_distance);
+
+        const int mask = _mm_movemask_pd(hit);
+        out.hit_mask[i] = mask & 1;
+        out.hit_mask[i + 1] = (mask >> 1) & 1;
+    }
+#endif
+
+    TryCollectPointsScalar(a.x, a.y, v_x, v_y, v_len2, gatherer_width, items, i, out);
+}
+
+StaticColliders::StaticColliders(std::vector<Item> colliders, double max_gatherer_width)
+    : colliders_(std::move(colliders))
+    , max_width_(0)
+    , grid_(0) {
+    for (const auto& collider : colliders_) {
+        max_width_ = std::max(max_width_, collider.width);
+    }
+    grid_ = SpatialGrid(2 * (max_gatherer_width + max_width_));
+    for (size_t k = 0; k < colliders_.size(); ++k) {
+        grid_.Insert(k, colliders_[k].position);
+    }
+}
+
+namespace {
+
+// данные поиска, общие для всех собирателей; после построения только читаются
+class GatherSearch {
+public:
+    explicit GatherSearch(const SpanProvider& provider)
+        : gatherers_(provider.Gatherers())
+        , items_(provider.Items())
+        , item_grid_(0) {
+        double max_gath_width = 0;
+        for (const auto& gath : gatherers_) {
+            max_gath_width = std::max(max_gath_width, gath.width);
+        }
+        for (const auto& item : items_) {
+            max_item_width_ = std::max(max_item_width_, item.width);
+        }
+
+        item_grid_ = SpatialGrid(2 * (max_gath_width + max_item_width_));
+        for (size_t j = 0; j < items_.size(); ++j) {
+            item_grid_.Insert(j, items_[j].position);
+        }
+
+        // сетку офисов строим, только если ее не передали готовой
+        offices_ = provider.OfficeColliders();
+        if (offices_ == nullptr) {
+            const auto offices = provider.Offices();
+            local_offices_.emplace(std::vector<Item>(offices.begin(), offices.end()), max_gath_width);
+            offices_ = &*local_offices_;
+        }
+    }
+
+    GatherSearch(const GatherSearch&) = delete;
+    GatherSearch& operator=(const GatherSearch&) = delete;
+
+    // кандидаты перебираются в том же порядке, что и в полном переборе,
+    // поэтому после сортировки по времени порядок событий совпадает
+    void Collect(size_t i, std::vector<size_t>& candidates, std::vector<IndexedGatheringEvent>& out) const {
+        const IndexedGatherer& gath = gatherers_[i];
+
+        if (IsPointEquals(gath.start_pos, gath.end_pos)) {
+            return;
+        }
+
+        item_grid_.Query(gath.start_pos, gath.end_pos, gath.width + max_item_width_, candidates);
+        for (size_t j : candidates) {
+            const Item& item = items_[j];
+            auto try_collision = TryCollectPoint(gath.start_pos, gath.end_pos, item.position);
+
+            if (try_collision.IsCollected(gath.width + item.width)) {
+                out.push_back({ false, item.id, i, try_collision.sq_distance, try_collision.proj_ratio });
+            }
+        }
+
+        const auto office_colliders = offices_->Colliders();
+        offices_->Grid().Query(gath.start_pos, gath.end_pos, gath.width + offices_->MaxWidth(), candidates);
+        for (size_t k : candidates) {
+            const Item& office = office_colliders[k];
+            auto try_collision = TryCollectPoint(gath.start_pos, gath.end_pos, office.position);
+
+            if (try_collision.IsCollected(gath.width + office.width)) {
+                out.push_back({ true, office.id, i, try_collision.sq_distance, try_collision.proj_ratio });
+            }
+        }
+    }
+
+private:
+    std::span<const IndexedGatherer> gatherers_;
+    std::span<const Item> items_;
+    double max_item_width_ = 0;
+    SpatialGrid item_grid_;
+    std::optional<StaticColliders> local_offices_;
+    const StaticColliders* offices_ = nullptr;
+};
+
+}  // namespace
+
+void FindGatherEvents(const SpanProvider& provider, std::vector<IndexedGatheringEvent>& result) {
+    result.clear();
+
+    if (provider.GatherersCount() == 0) {
+        return;
+    }
+
+    GatherSearch search(provider);
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < provider.GatherersCount(); ++i) {
+        search.Collect(i, candidates, result);
+    }
+
+    std::sort(result.begin(), result.end(), SortIndexedByTime);
+}
+
+void FindGatherEventsParallel(const SpanProvider& provider, util::WorkStealingPool& pool,
+    ParallelGatherBuffers& buffers, std::vector<IndexedGatheringEvent>& result) {
+    result.clear();
+
+    const auto gatherers = provider.Gatherers();
+    if (gatherers.empty()) {
+        return;
+    }
+
+    const GatherSearch search(provider);
+
+    // собиратели группируются по плиткам начальной точки, чтобы блок задач
+    // обращался к соседним ячейкам сетки предметов
+    auto tile_of = [](geom::Point2D p) {
+        return std::pair{ std::floor(p.y / GATHER_TILE_SIZE), std::floor(p.x / GATHER_TILE_SIZE) };
+    };
+    buffers.order.resize(gatherers.size());
+    for (size_t i = 0; i < gatherers.size(); ++i) {
+        buffers.order[i] = i;
+    }
+    std::sort(buffers.order.begin(), buffers.order.end(), [&](size_t l, size_t r) {
+        const auto lt = tile_of(gatherers[l].start_pos);
+        const auto rt = tile_of(gatherers[r].start_pos);
+        return lt != rt ? lt < rt : l < r;
+    });
+
+    const size_t chunks = (gatherers.size() + GATHER_CHUNK_SIZE - 1) / GATHER_CHUNK_SIZE;
+    buffers.chunk_events.resize(std::max(buffers.chunk_events.size(), chunks));
+    buffers.candidates.resize(pool.WorkersCount());
+
+    pool.Run(chunks, [&](size_t worker, size_t chunk) {
+        auto& events = buffers.chunk_events[chunk];
+        events.clear();
+        const size_t end = std::min(gatherers.size(), (chunk + 1) * GATHER_CHUNK_SIZE);
+        for (size_t n = chunk * GATHER_CHUNK_SIZE; n < end; ++n) {
+            search.Collect(buffers.order[n], buffers.candidates[worker], events);
+        }
+    });
+
+    // восстанавливаем порядок последовательного перебора: события собирателя идут подряд,
+    // собиратели - по возрастанию индекса. Внутри собирателя порядок сохранен.
+    buffers.offsets.assign(gatherers.size() + 1, 0);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (const auto& event : buffers.chunk_events[chunk]) {
+            ++buffers.offsets[event.gatherer_idx + 1];
+        }
+    }
+    for (size_t i = 0; i < gatherers.size(); ++i) {
+        buffers.offsets[i + 1] += buffers.offsets[i];
+    }
+    result.resize(buffers.offsets.back());
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (const auto& event : buffers.chunk_events[chunk]) {
+            result[buffers.offsets[event.gatherer_idx]++] = event;
+        }
+    }
+
+    std::sort(result.begin(), result.end(), SortIndexedByTime);
+}
+
+std::vector<IndexedGatheringEvent> FindGatherEvents(const SpanProvider& provider) {
+    std::vector<IndexedGatheringEvent> result;
+    FindGatherEvents(provider, result);
+    return result;
+}
+
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    std::vector<Token> tokens;
+    std::vector<IndexedGatherer> gatherers;
+    tokens.reserve(provider.GatherersCount());
+    gatherers.reserve(provider.GatherersCount());
+    for (size_t i = 0; i < provider.GatherersCount(); ++i) {
+        Gatherer gath = provider.GetGatherer(i);
+        gatherers.push_back({ gath.start_pos, gath.end_pos, gath.width });
+        tokens.push_back(std::move(gath.token));
+    }
+
+    std::vector<Item> items;
+    items.reserve(provider.ItemsCount());
+    for (size_t j = 0; j < provider.ItemsCount(); ++j) {
+        items.push_back(provider.GetItem(j));
+    }
+
+    std::vector<Item> offices;
+    offices.reserve(provider.OfficeCount());
+    for (size_t k = 0; k < provider.OfficeCount(); ++k) {
+        Office office = provider.GetOffice(k);
+        offices.push_back({ k, office.position, office.width });
+    }
+
+    std::vector<GatheringEvent> result;
+    for (const auto& event : FindGatherEvents(SpanProvider{ items, gatherers, offices })) {
+        result.push_back({ event.is_office, event.is_office ? OFFICE_EVENT_ID : event.item_id,
+            tokens[event.gatherer_idx], event.sq_distance, event.time });
+    }
+    return result;
+}
+
+std::vector<GatheringEvent> FindGatherEventsBruteForce(const ItemGathererProvider& provider) {
     std::vector<GatheringEvent> result;
 
     for (size_t i = 0; i < provider.GatherersCount(); ++i) {
@@ -45,7 +423,7 @@ std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provide
             auto try_collision = TryCollectPoint(gath.start_pos, gath.end_pos, office.position);
 
             if (try_collision.IsCollected(gath.width + office.width)) {
-                GatheringEvent collision{ true,  777777, gath.token, try_collision.sq_distance, try_collision.proj_ratio };
+                GatheringEvent collision{ true,  OFFICE_EVENT_ID, gath.token, try_collision.sq_distance, try_collision.proj_ratio };
                 result.push_back(collision);
             }
         }
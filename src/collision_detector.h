@@ -1,9 +1,17 @@
 #pragma once
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 #include "geom.h"
 #include "player_tokens.h"
 
+namespace util {
+class WorkStealingPool;
+}
 
 namespace collision_detector {
 
@@ -25,6 +33,48 @@ struct CollectionResult {
 
 CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c);
 
+// предметы в виде структуры массивов для пакетной проверки
+struct PackedItems {
+    std::vector<size_t> id;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> width;
+
+    void Reserve(size_t n) {
+        id.reserve(n);
+        x.reserve(n);
+        y.reserve(n);
+        width.reserve(n);
+    }
+
+    void Add(size_t item_id, geom::Point2D pos, double item_width) {
+        id.push_back(item_id);
+        x.push_back(pos.x);
+        y.push_back(pos.y);
+        width.push_back(item_width);
+    }
+
+    size_t Size() const {
+        return id.size();
+    }
+};
+
+// результат пакетной проверки, i-й элемент каждого массива относится к i-му предмету
+struct BatchCollectionResult {
+    std::vector<std::uint8_t> hit_mask;
+    std::vector<double> sq_distance;
+    std::vector<double> proj_ratio;
+};
+
+/*
+ * Пакетный вариант TryCollectPoint: один отрезок a-b против всех предметов.
+ * Считает те же величины теми же операциями, что и скалярная версия (AVX2/SSE2,
+ * если доступны при сборке). hit_mask[i] == 1, если предмет попадает в радиус
+ * gatherer_width + items.width[i]. Для вырожденного отрезка (a == b) попаданий нет.
+ */
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width,
+    const PackedItems& items, BatchCollectionResult& out);
+
 struct Item {
     size_t id;
     geom::Point2D position;
@@ -65,6 +115,9 @@ struct GatheringEvent {
     double time;
 };
 
+// item_id офисных событий в GatheringEvent
+const size_t OFFICE_EVENT_ID = 777777;
+
 static auto IsPointEquals = [](geom::Point2D p1, geom::Point2D p2) {
     return (p1.x == p2.x) && (p1.y == p2.y);
 };
@@ -73,8 +126,84 @@ static auto SortByTime = [](const GatheringEvent& l, const GatheringEvent& r) {
     return l.time < r.time;
 };
 
+// поиск событий через сетку (broadphase), результат совпадает с FindGatherEventsBruteForce
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
+// полный перебор всех пар собиратель-предмет, эталон для проверки
+std::vector<GatheringEvent> FindGatherEventsBruteForce(const ItemGathererProvider& provider);
+
+const double MIN_GRID_CELL_SIZE = 1.0;
+
+/*
+ * Равномерная сетка для отбора кандидатов на столкновение.
+ * В ячейку кладутся индексы точек, запрос возвращает индексы из всех ячеек,
+ * которые пересекает прямоугольник отрезка, расширенный на радиус.
+ */
+class SpatialGrid {
+public:
+    explicit SpatialGrid(double cell_size)
+        : cell_size_(std::max(cell_size, MIN_GRID_CELL_SIZE)) {}
+
+    void Insert(size_t idx, geom::Point2D pos);
+
+    // pos должна совпадать с позицией, переданной в Insert
+    void Remove(size_t idx, geom::Point2D pos);
+
+    // индексы возвращаются по возрастанию и без повторов
+    void Query(geom::Point2D a, geom::Point2D b, double radius, std::vector<size_t>& out) const;
+
+    size_t Size() const {
+        return count_;
+    }
+
+private:
+    using CellKey = std::uint64_t;
+
+    struct Cell {
+        std::int64_t cx;
+        std::int64_t cy;
+        std::vector<size_t> indexes;
+    };
+
+    std::int64_t ToCell(double coord) const {
+        return static_cast<std::int64_t>(std::floor(coord / cell_size_));
+    }
+
+    static CellKey MakeKey(std::int64_t cx, std::int64_t cy) {
+        return (static_cast<CellKey>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+    }
+
+    double cell_size_;
+    size_t count_ = 0;
+    std::unordered_map<CellKey, Cell> cells_;
+};
+
+/*
+ * Неподвижные коллайдеры (офисы карты). Сетка строится один раз при создании
+ * и дальше используется всеми сессиями карты без изменений.
+ */
+class StaticColliders {
+public:
+    StaticColliders(std::vector<Item> colliders, double max_gatherer_width);
+
+    std::span<const Item> Colliders() const noexcept {
+        return colliders_;
+    }
+
+    const SpatialGrid& Grid() const noexcept {
+        return grid_;
+    }
+
+    double MaxWidth() const noexcept {
+        return max_width_;
+    }
+
+private:
+    std::vector<Item> colliders_;
+    double max_width_;
+    SpatialGrid grid_;
+};
+
 class TrophyProvider : public collision_detector::ItemGathererProvider {
 public:
     TrophyProvider(const std::vector<collision_detector::Item>& items,
@@ -109,4 +238,109 @@ private:
     std::vector<collision_detector::Office> office_;
 };
 
+// собиратель без токена, его идентификатор - индекс в переданном массиве
+struct IndexedGatherer {
+    geom::Point2D start_pos;
+    geom::Point2D end_pos;
+    double width;
+};
+
+struct IndexedGatheringEvent {
+    bool is_office;
+    // id предмета или индекс офиса
+    size_t item_id;
+    size_t gatherer_idx;
+    double sq_distance;
+    double time;
+};
+
+static auto SortIndexedByTime = [](const IndexedGatheringEvent& l, const IndexedGatheringEvent& r) {
+    return l.time < r.time;
+};
+
+/*
+ * Невиртуальный провайдер поверх массивов вызывающей стороны, данные не копируются.
+ * Офисы передаются как Item, где id - индекс офиса на карте.
+ */
+class SpanProvider {
+public:
+    SpanProvider(std::span<const Item> items, std::span<const IndexedGatherer> gatherers,
+        std::span<const Item> offices) noexcept :
+        items_(items),
+        gatherers_(gatherers),
+        offices_(offices) {}
+
+    // офисы с заранее построенной сеткой
+    SpanProvider(std::span<const Item> items, std::span<const IndexedGatherer> gatherers,
+        const StaticColliders& offices) noexcept :
+        items_(items),
+        gatherers_(gatherers),
+        offices_(offices.Colliders()),
+        office_colliders_(&offices) {}
+
+    size_t ItemsCount() const noexcept {
+        return items_.size();
+    }
+    const Item& GetItem(size_t idx) const noexcept {
+        return items_[idx];
+    }
+    size_t GatherersCount() const noexcept {
+        return gatherers_.size();
+    }
+    const IndexedGatherer& GetGatherer(size_t idx) const noexcept {
+        return gatherers_[idx];
+    }
+    size_t OfficeCount() const noexcept {
+        return offices_.size();
+    }
+    const Item& GetOffice(size_t idx) const noexcept {
+        return offices_[idx];
+    }
+
+    std::span<const Item> Items() const noexcept {
+        return items_;
+    }
+    std::span<const IndexedGatherer> Gatherers() const noexcept {
+        return gatherers_;
+    }
+    std::span<const Item> Offices() const noexcept {
+        return offices_;
+    }
+    const StaticColliders* OfficeColliders() const noexcept {
+        return office_colliders_;
+    }
+
+private:
+    std::span<const Item> items_;
+    std::span<const IndexedGatherer> gatherers_;
+    std::span<const Item> offices_;
+    const StaticColliders* office_colliders_ = nullptr;
+};
+
+std::vector<IndexedGatheringEvent> FindGatherEvents(const SpanProvider& provider);
+
+// то же, но результат пишется в переданный буфер, чтобы не выделять память каждый тик
+void FindGatherEvents(const SpanProvider& provider, std::vector<IndexedGatheringEvent>& result);
+
+// сторона плитки, по которой собиратели группируются в блоки параллельного поиска
+const double GATHER_TILE_SIZE = 16.0;
+const size_t GATHER_CHUNK_SIZE = 512;
+
+// буферы параллельного поиска, переиспользуются между тиками
+struct ParallelGatherBuffers {
+    std::vector<size_t> order;
+    std::vector<std::vector<size_t>> candidates;
+    std::vector<std::vector<IndexedGatheringEvent>> chunk_events;
+    std::vector<size_t> offsets;
+};
+
+/*
+ * Параллельный вариант FindGatherEvents для больших сессий. Сетка предметов строится
+ * один раз, собиратели разбиваются на блоки по пространственным плиткам и обрабатываются
+ * на пуле. Затем события собираются в порядке последовательного перебора и сортируются
+ * так же, поэтому результат совпадает с FindGatherEvents.
+ */
+void FindGatherEventsParallel(const SpanProvider& provider, util::WorkStealingPool& pool,
+    ParallelGatherBuffers& buffers, std::vector<IndexedGatheringEvent>& result);
+
 }  //collision_detector
\ No newline at end of file
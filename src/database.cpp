@@ -1,38 +1,43 @@
+#include <cmath>
 #include "database.h"
 
 
 namespace db {
-    void Database::WriteToBD(const GameRecords& gr) {
-        using namespace std::literals;
-        using pqxx::operator"" _zv;
+    void Database::WriteRecords(const std::vector<GameRecords>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        // столбцы уходят массивами: один план и один обмен с сервером на всю пачку
+        std::vector<std::string> ids;
+        std::vector<std::string> names;
+        std::vector<std::int64_t> scores;
+        std::vector<std::int64_t> play_times;
+        ids.reserve(records.size());
+        names.reserve(records.size());
+        scores.reserve(records.size());
+        play_times.reserve(records.size());
+        for (const GameRecords& gr : records) {
+            ids.push_back(util::PlayerId::New().ToString());
+            names.push_back(gr.name);
+            scores.push_back(static_cast<std::int64_t>(gr.score));
+            // время округляется к ближайшему, как при записи double в integer-колонку
+            play_times.push_back(std::llrint(gr.played_time));
+        }
 
         auto conn = cp_.GetConnection();
         pqxx::work work{ *conn };
-
-        work.exec("START TRANSACTION"_zv);
-        work.exec_params(
-            R"(INSERT INTO retired_players (id, name, score, play_time_ms) VALUES ($1, $2, $3, $4);
-        )"_zv, util::PlayerId::New().ToString(), gr.name, gr.score, gr.played_time);
+        work.exec_prepared(INSERT_RECORDS, ids, names, scores, play_times);
         work.commit();
     }
 
-    const std::vector<GameRecords> Database::GetRecords(int offset, int max_elem) {
-        using namespace std::literals;
-        using pqxx::operator"" _zv;
-
-        std::vector<GameRecords> records;
+    void Database::ReadAllRecords(const std::function<void(std::string name, std::uint64_t score, std::int64_t play_time_ms)>& fn) {
         auto conn = cp_.GetConnection();
         pqxx::read_transaction tx{ *conn };
 
-        tx.exec("START TRANSACTION"_zv);
-        auto author_req = "SELECT name, score, play_time_ms FROM retired_players ORDER BY score DESC, play_time_ms, name LIMIT " + std::to_string(max_elem) + " OFFSET " + std::to_string(offset) + ";";
-
-        for (auto [name, score, play_time_ms] : tx.query<std::string, size_t, size_t>(author_req)) {
-            GameRecords gr{ name, score, static_cast<double>(play_time_ms) / 1000 };
-            records.push_back(gr);
+        for (const auto& row : tx.exec_prepared(SELECT_ALL_RECORDS)) {
+            fn(row[0].as<std::string>(), row[1].as<std::uint64_t>(), row[2].as<std::int64_t>());
         }
         tx.commit();
-
-        return records;
     }
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <functional>
 #include "database_addition_struct.h"
 #include "db_connector.h"
 
@@ -9,9 +11,14 @@ namespace db {
     class Database {
     public:
         Database(const DBSetting& dbs) :
-            cp_{ dbs.num_connections, [url = std::move(dbs.url)]{
+            cp_{ dbs.num_connections, dbs.connection_wait, [url = std::move(dbs.url)]{
             auto conn = std::make_shared<pqxx::connection>(url);
             conn->prepare("select_one", "SELECT 1;");
+            conn->prepare(INSERT_RECORDS, R"(
+                INSERT INTO retired_players (id, name, score, play_time_ms)
+                SELECT * FROM unnest($1::uuid[], $2::varchar[], $3::integer[], $4::integer[]);
+                )");
+            conn->prepare(SELECT_ALL_RECORDS, "SELECT name, score, play_time_ms FROM retired_players;");
             return conn; } }
         {
             auto conn = cp_.GetConnection();
@@ -33,11 +40,17 @@ namespace db {
             work.commit();
         }
 
-            void WriteToBD(const GameRecords& gr);
-            const std::vector<GameRecords> GetRecords(int offset, int max_elem);
+            // пачка записей одним подготовленным INSERT с массивами в параметрах
+            void WriteRecords(const std::vector<GameRecords>& records);
+            // все записи без сортировки, для заполнения таблицы рекордов в памяти
+            void ReadAllRecords(const std::function<void(std::string name, std::uint64_t score, std::int64_t play_time_ms)>& fn);
 
 
     private:
+        // подготовленные запросы регистрируются при создании каждого соединения
+        static constexpr char INSERT_RECORDS[] = "insert_records";
+        static constexpr char SELECT_ALL_RECORDS[] = "select_all_records";
+
         db_conn::ConnectionPool cp_;
     };
 }
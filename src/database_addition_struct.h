@@ -1,18 +1,26 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include "tagged_uuid.h"
 
 namespace db {
 
     const int MAX_DB_CONNECTION = 10;
+    const std::chrono::milliseconds CONNECTION_WAIT_TIMEOUT{ 2000 };
     const int DEFAULT_OFFSET = 0;
     const double DEFAULT_MAX_ELEMENT = 100;
     const std::string OFFSET_STR = "start=";
     const std::string MAX_ELEMENT_STR = "maxItems=";
+    // курсор страницы рекордов - последняя запись предыдущей страницы
+    const std::string AFTER_SCORE_STR = "afterScore=";
+    const std::string AFTER_PLAY_TIME_STR = "afterPlayTime=";
+    const std::string AFTER_NAME_STR = "afterName=";
 
 
     struct DBSetting {
         std::string url;
         size_t num_connections;
+        std::chrono::milliseconds connection_wait = CONNECTION_WAIT_TIMEOUT;
     };
 
     struct GameRecords {
@@ -20,6 +28,13 @@ namespace db {
         size_t score;
         double played_time;
     };
+
+    // ключ записи в порядке таблицы рекордов
+    struct RecordCursor {
+        std::uint64_t score;
+        std::int64_t play_time_ms;
+        std::string name;
+    };
 }
 
 namespace util {
@@ -1,12 +1,20 @@
 #pragma once
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <pqxx/pqxx>
+#include <stdexcept>
 #include <vector>
 
 namespace db_conn {
+    //        
+    class PoolTimeout : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
     class ConnectionPool {
         using PoolType = ConnectionPool;
         using ConnectionPtr = std::shared_ptr<pqxx::connection>;
@@ -47,7 +55,8 @@ namespace db_conn {
 
         // ConnectionFactory is a functional object returning std::shared_ptr<pqxx::connection>
         template <typename ConnectionFactory>
-        ConnectionPool(size_t capacity, ConnectionFactory&& connection_factory) {
+        ConnectionPool(size_t capacity, std::chrono::milliseconds wait_timeout, ConnectionFactory&& connection_factory)
+            : wait_timeout_{ wait_timeout } {
             pool_.reserve(capacity);
             for (size_t i = 0; i < capacity; ++i) {
                 pool_.emplace_back(connection_factory());
@@ -57,10 +66,12 @@ namespace db_conn {
         ConnectionWrapper GetConnection() {
             std::unique_lock lock{ mutex_ };
             //     ,  cond_var_      
-            //    
-            cond_var_.wait(lock, [this] {
+            //    ,    wait_timeout_,   PoolTimeout
+            if (!cond_var_.wait_for(lock, wait_timeout_, [this] {
                 return used_connections_ < pool_.size();
-                });
+                })) {
+                throw PoolTimeout("no free database connection");
+            }
             //        
 
             return { std::move(pool_[used_connections_++]), *this };
@@ -82,6 +93,7 @@ namespace db_conn {
         std::condition_variable cond_var_;
         std::vector<ConnectionPtr> pool_;
         size_t used_connections_ = 0;
+        const std::chrono::milliseconds wait_timeout_;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include <cmath>
+#include "event_simulation.h"
+
+namespace event_sim {
+
+namespace {
+
+// очередь пересобирается, когда в ней накопилось столько устаревших событий
+const size_t MIN_STALE_TO_COMPACT = 1024;
+
+geom::Point2D ToPoint(const model::Position& pos) {
+    return { pos.x_pos, pos.y_pos };
+}
+
+}  // namespace
+
+model::Position EventSimulator::ComputeStopPosition(const model::Map& map, const model::Position& pos, const model::Speed& speed) {
+    if (speed == model::ZEROSPEED) {
+        return pos;
+    }
+
+    // как и в Dog::GetMaxMovePosition, направление определяется по вертикальной скорости
+    const bool horizontal = speed.v_speed == 0;
+    const double sign = horizontal ? (speed.h_speed > 0 ? 1.0 : -1.0) : (speed.v_speed > 0 ? 1.0 : -1.0);
+
+    model::Position reach = pos;
+    double& coord = horizontal ? reach.x_pos : reach.y_pos;
+
+    // переходим с дороги на дорогу, пока край очередной дороги отодвигает точку остановки
+    for (;;) {
+        double best = coord;
+        for (const model::Road* road : map.GetRoadAtPoint(reach)) {
+            auto border = road->GetBorderRoad();
+            double limit;
+            if (horizontal) {
+                limit = sign > 0 ? border.second.x_pos : border.first.x_pos;
+            }
+            else {
+                limit = sign > 0 ? border.second.y_pos : border.first.y_pos;
+            }
+            if (sign * (limit - best) > 0) {
+                best = limit;
+            }
+        }
+        if (best == coord) {
+            break;
+        }
+        coord = best;
+    }
+    return reach;
+}
+
+void EventSimulator::OnDogMovementChanged(const model::GameSession& session, model::Dog* dog,
+    const collision_detector::StaticColliders& offices) {
+    // до первого тика состояние сессии не создано, траектории посчитаются при инициализации
+    if (SessionState* state = FindState(session)) {
+        Schedule(*state, session, dog, offices);
+    }
+}
+
+void EventSimulator::OnDogRemoved(const model::GameSession& session, const model::Dog* dog) {
+    if (SessionState* state = FindState(session)) {
+        DropMotion(*state, dog);
+    }
+}
+
+void EventSimulator::OnTrophyAdded(const model::GameSession& session, const model::Trophy& trophy) {
+    SessionState* state = FindState(session);
+    if (state == nullptr) {
+        return;
+    }
+
+    const geom::Point2D pos = ToPoint(trophy.GetPosition());
+    state->items.Insert(trophy.GetId(), pos);
+
+    for (const model::Dog* dog : state->moving) {
+        Motion& motion = state->motions.at(dog);
+        auto try_collision = collision_detector::TryCollectPoint(ToPoint(motion.start), ToPoint(motion.stop), pos);
+        if (try_collision.IsCollected(collision_detector::DOG_COLLIDER_SIZE + collision_detector::ITEM_COLLIDER_SIZE)) {
+            double time = GetEventTime(motion, try_collision.proj_ratio);
+            // предмет позади собаки уже не подобрать
+            if (time >= state->now) {
+                Push(*state, motion, EventType::Item, trophy.GetId(), time);
+            }
+        }
+    }
+}
+
+void EventSimulator::AttachSession(model::GameSession& session, const collision_detector::StaticColliders& offices) {
+    if (FindState(session) == nullptr) {
+        InitState(session, offices);
+    }
+}
+
+void EventSimulator::Advance(model::GameSession& session, size_t delta_time, const collision_detector::StaticColliders& offices) {
+    SessionState* found = FindState(session);
+    SessionState& state = found ? *found : InitState(session, offices);
+
+    const double target_time = state.now + static_cast<double>(delta_time);
+
+    while (!state.queue.empty() && state.queue.top().time <= target_time) {
+        Event event = state.queue.top();
+        state.queue.pop();
+
+        auto it = state.motions.find(event.dog);
+        if (it == state.motions.end() || it->second.version != event.version) {
+            if (state.stale > 0) {
+                --state.stale;
+            }
+            continue;
+        }
+
+        --it->second.scheduled;
+        ApplyEvent(state, session, event, it->second);
+    }
+
+    state.now = target_time;
+
+    for (const model::Dog* dog : state.moving) {
+        Motion& motion = state.motions.at(dog);
+        motion.dog->SetPosition(GetPositionAt(motion, target_time));
+    }
+
+    if (state.stale >= MIN_STALE_TO_COMPACT && state.stale * 2 > state.queue.size()) {
+        CompactQueue(state);
+    }
+}
+
+EventSimulator::SessionState& EventSimulator::InitState(model::GameSession& session, const collision_detector::StaticColliders& offices) {
+    SessionState& state = sessions_[&session];
+
+    for (const auto& [id, trophy] : session.GetTrophyList()) {
+        state.items.Insert(id, ToPoint(trophy.GetPosition()));
+    }
+
+    for (const auto& [id, dog] : session.GetDogs()) {
+        Schedule(state, session, dog, offices);
+    }
+
+    return state;
+}
+
+EventSimulator::SessionState* EventSimulator::FindState(const model::GameSession& session) {
+    auto it = sessions_.find(&session);
+    return it == sessions_.end() ? nullptr : &it->second;
+}
+
+void EventSimulator::Schedule(SessionState& state, const model::GameSession& session, model::Dog* dog,
+    const collision_detector::StaticColliders& offices) {
+    DropMotion(state, dog);
+
+    const model::Speed speed = dog->GetSpeed();
+    if (speed == model::ZEROSPEED) {
+        return;
+    }
+
+    Motion& motion = state.motions[dog];
+    motion.dog = dog;
+    motion.version = state.next_version++;
+    motion.start = dog->GetPosition();
+    motion.start_time = state.now;
+    motion.speed = speed;
+    motion.stop = ComputeStopPosition(*session.GetMap(), motion.start, speed);
+
+    const double distance = std::abs(motion.stop.x_pos - motion.start.x_pos) + std::abs(motion.stop.y_pos - motion.start.y_pos);
+    const double abs_speed = std::abs(speed.h_speed) + std::abs(speed.v_speed);
+    motion.stop_time = motion.start_time + distance / abs_speed * 1000;
+
+    if (motion.stop == motion.start) {
+        // собака уже стоит на краю дорог, событий не будет
+        return;
+    }
+
+    state.moving.insert(dog);
+    Push(state, motion, EventType::Boundary, 0, motion.stop_time);
+
+    const geom::Point2D a = ToPoint(motion.start);
+    const geom::Point2D b = ToPoint(motion.stop);
+
+    std::vector<size_t> candidates;
+    const double item_radius = collision_detector::DOG_COLLIDER_SIZE + collision_detector::ITEM_COLLIDER_SIZE;
+    state.items.Query(a, b, item_radius, candidates);
+    const auto& trophies = session.GetTrophyList();
+    for (size_t id : candidates) {
+        auto trophy = trophies.find(id);
+        if (trophy == trophies.end()) {
+            continue;
+        }
+        auto try_collision = collision_detector::TryCollectPoint(a, b, ToPoint(trophy->second.GetPosition()));
+        if (try_collision.IsCollected(item_radius)) {
+            Push(state, motion, EventType::Item, id, GetEventTime(motion, try_collision.proj_ratio));
+        }
+    }
+
+    const auto office_colliders = offices.Colliders();
+    offices.Grid().Query(a, b, collision_detector::DOG_COLLIDER_SIZE + offices.MaxWidth(), candidates);
+    for (size_t k : candidates) {
+        const auto& office = office_colliders[k];
+        auto try_collision = collision_detector::TryCollectPoint(a, b, office.position);
+        if (try_collision.IsCollected(collision_detector::DOG_COLLIDER_SIZE + office.width)) {
+            Push(state, motion, EventType::Office, office.id, GetEventTime(motion, try_collision.proj_ratio));
+        }
+    }
+}
+
+void EventSimulator::DropMotion(SessionState& state, const model::Dog* dog) {
+    auto it = state.motions.find(dog);
+    if (it == state.motions.end()) {
+        return;
+    }
+    state.stale += it->second.scheduled;
+    state.moving.erase(dog);
+    state.motions.erase(it);
+}
+
+void EventSimulator::Push(SessionState& state, Motion& motion, EventType type, size_t target, double time) {
+    state.queue.push({ time, motion.version, type, target, motion.dog });
+    ++motion.scheduled;
+}
+
+void EventSimulator::ApplyEvent(SessionState& state, model::GameSession& session, const Event& event, Motion& motion) {
+    switch (event.type) {
+    case EventType::Boundary:
+        motion.dog->SetPosition(motion.stop);
+        state.moving.erase(motion.dog);
+        break;
+    case EventType::Item: {
+        const auto& trophies = session.GetTrophyList();
+        auto trophy = trophies.find(event.target);
+        // предмет мог подобрать кто-то раньше
+        if (trophy == trophies.end() || !motion.dog->HasMoreCapacity()) {
+            break;
+        }
+        state.items.Remove(event.target, ToPoint(trophy->second.GetPosition()));
+        motion.dog->AddItemToBag(trophy->second);
+        session.RemoveTrophy(event.target);
+        break;
+    }
+    case EventType::Office:
+        motion.dog->ReturnTrophyToOffice();
+        break;
+    }
+}
+
+void EventSimulator::CompactQueue(SessionState& state) {
+    EventQueue compacted;
+    while (!state.queue.empty()) {
+        const Event& event = state.queue.top();
+        auto it = state.motions.find(event.dog);
+        if (it != state.motions.end() && it->second.version == event.version) {
+            compacted.push(event);
+        }
+        state.queue.pop();
+    }
+    state.queue = std::move(compacted);
+    state.stale = 0;
+}
+
+double EventSimulator::GetEventTime(const Motion& motion, double proj_ratio) {
+    return motion.start_time + proj_ratio * (motion.stop_time - motion.start_time);
+}
+
+model::Position EventSimulator::GetPositionAt(const Motion& motion, double time) {
+    if (time >= motion.stop_time) {
+        return motion.stop;
+    }
+    const double dt = time - motion.start_time;
+    return { motion.start.x_pos + motion.speed.h_speed * dt / 1000, motion.start.y_pos + motion.speed.v_speed * dt / 1000 };
+}
+
+}  // event_sim
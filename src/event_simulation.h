@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "collision_detector.h"
+#include "model.h"
+
+namespace event_sim {
+
+/*
+ * Событийная модель движения собак.
+ * Собаки двигаются вдоль осей с постоянной скоростью, поэтому для каждой движущейся
+ * собаки заранее считается время выхода на край дорог, подбора предмета и прохода
+ * через офис. События лежат в очереди с приоритетом, тик обрабатывает только
+ * наступившие события, так что длинный тик считается так же точно, как много коротких.
+ *
+ * Траектория пересчитывается, когда собака меняет скорость или появляется новый
+ * предмет. Устаревшие события не удаляются из очереди, а отбрасываются при извлечении.
+ */
+class EventSimulator {
+public:
+    // пересчитывает траекторию собаки с текущего момента времени сессии
+    void OnDogMovementChanged(const model::GameSession& session, model::Dog* dog,
+        const collision_detector::StaticColliders& offices);
+
+    void OnDogRemoved(const model::GameSession& session, const model::Dog* dog);
+
+    void OnTrophyAdded(const model::GameSession& session, const model::Trophy& trophy);
+
+    // создает состояние сессии, если его еще нет; после этого Advance для разных сессий
+    // можно вызывать из разных потоков
+    void AttachSession(model::GameSession& session, const collision_detector::StaticColliders& offices);
+
+    // продвигает время сессии на delta_time мс и применяет наступившие события
+    void Advance(model::GameSession& session, size_t delta_time, const collision_detector::StaticColliders& offices);
+
+    // точка, в которой собака упрется в край дорог, двигаясь с заданной скоростью
+    static model::Position ComputeStopPosition(const model::Map& map, const model::Position& pos, const model::Speed& speed);
+
+private:
+    enum class EventType {
+        Boundary,
+        Item,
+        Office
+    };
+
+    struct Event {
+        double time;
+        std::uint64_t version;
+        EventType type;
+        size_t target;
+        model::Dog* dog;
+    };
+
+    struct EventLater {
+        bool operator()(const Event& l, const Event& r) const {
+            if (l.time != r.time) {
+                return l.time > r.time;
+            }
+            if (l.version != r.version) {
+                return l.version > r.version;
+            }
+            if (l.type != r.type) {
+                return l.type > r.type;
+            }
+            return l.target > r.target;
+        }
+    };
+
+    struct Motion {
+        model::Dog* dog;
+        std::uint64_t version;
+        model::Position start;
+        double start_time;
+        model::Speed speed;
+        model::Position stop;
+        double stop_time;
+        size_t scheduled = 0;
+    };
+
+    using EventQueue = std::priority_queue<Event, std::vector<Event>, EventLater>;
+
+    struct SessionState {
+        double now = 0;
+        std::uint64_t next_version = 1;
+        std::unordered_map<const model::Dog*, Motion> motions;
+        // собаки, которые еще не дошли до края дорог
+        std::unordered_set<const model::Dog*> moving;
+        collision_detector::SpatialGrid items{ 2 * (collision_detector::DOG_COLLIDER_SIZE + collision_detector::ITEM_COLLIDER_SIZE) };
+        EventQueue queue;
+        size_t stale = 0;
+    };
+
+    SessionState& InitState(model::GameSession& session, const collision_detector::StaticColliders& offices);
+    SessionState* FindState(const model::GameSession& session);
+
+    void Schedule(SessionState& state, const model::GameSession& session, model::Dog* dog,
+        const collision_detector::StaticColliders& offices);
+    void DropMotion(SessionState& state, const model::Dog* dog);
+    void Push(SessionState& state, Motion& motion, EventType type, size_t target, double time);
+    void ApplyEvent(SessionState& state, model::GameSession& session, const Event& event, Motion& motion);
+    void CompactQueue(SessionState& state);
+
+    static double GetEventTime(const Motion& motion, double proj_ratio);
+    static model::Position GetPositionAt(const Motion& motion, double time);
+
+    std::unordered_map<const model::GameSession*, SessionState> sessions_;
+};
+
+}  // event_sim
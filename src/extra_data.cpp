@@ -6,7 +6,7 @@ namespace extra_data {
         trophy_list_[map_id] = trophies;
     }
 
-    const json::array TrophyList::GetTrophy(const std::string& map_id) const {
+    const json::array& TrophyList::GetTrophy(const std::string& map_id) const {
         return trophy_list_.at(map_id);
     }
 }
\ No newline at end of file
@@ -8,7 +8,7 @@ namespace extra_data {
     class TrophyList {
     public:
         void AddTrophy(const std::string& map_id, const json::array& trophies);
-        const json::array GetTrophy(const std::string& map_id) const;
+        const json::array& GetTrophy(const std::string& map_id) const;
 
     private:
         std::unordered_map<std::string, json::array> trophy_list_;
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "file_record_store.h"
+
+namespace db {
+
+    namespace {
+
+        namespace ipc = boost::interprocess;
+
+        constexpr char FILE_MAGIC[8] = { 'D', 'O', 'G', 'R', 'E', 'C', '0', '1' };
+        constexpr size_t INITIAL_CAPACITY = 64 * 1024;
+        constexpr size_t RECORD_ALIGN = 8;
+
+        struct RecordHeader {
+            // заголовок и имя без выравнивания; 0 - записей дальше нет
+            std::uint32_t length;
+            std::uint32_t checksum;
+            std::uint64_t score;
+            std::int64_t play_time_ms;
+        };
+
+        size_t Align(size_t offset) {
+            return (offset + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+        }
+
+        // FNV-1a по очкам, времени и имени
+        std::uint32_t Checksum(std::uint64_t score, std::int64_t play_time_ms, const char* name, size_t name_size) {
+            std::uint32_t hash = 2166136261u;
+            auto mix = [&hash](const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash = (hash ^ bytes[i]) * 16777619u;
+                }
+            };
+            mix(&score, sizeof(score));
+            mix(&play_time_ms, sizeof(play_time_ms));
+            mix(name, name_size);
+            return hash;
+        }
+
+        // разбирает запись по offset; false - конец журнала или испорченный хвост
+        bool ReadRecord(const char* data, size_t capacity, size_t offset, RecordHeader& header) {
+            if (offset + sizeof(RecordHeader) > capacity) {
+                return false;
+            }
+            std::memcpy(&header, data + offset, sizeof(RecordHeader));
+            if (header.length < sizeof(RecordHeader) || header.length > capacity - offset) {
+                return false;
+            }
+            const char* name = data + offset + sizeof(RecordHeader);
+            return header.checksum == Checksum(header.score, header.play_time_ms, name, header.length - sizeof(RecordHeader));
+        }
+    }
+
+    FileRecordStore::FileRecordStore(std::filesystem::path path)
+        : path_(std::move(path)) {
+        if (!std::filesystem::exists(path_)) {
+            std::ofstream out(path_, std::ios::binary);
+            out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+            if (!out) {
+                throw std::runtime_error("Failed to create records file " + path_.string());
+            }
+            out.close();
+            std::filesystem::resize_file(path_, INITIAL_CAPACITY);
+        }
+        if (std::filesystem::file_size(path_) < sizeof(FILE_MAGIC)) {
+            throw std::runtime_error("Records file is too short: " + path_.string());
+        }
+        Map();
+
+        const char* data = static_cast<const char*>(region_.get_address());
+        if (std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            throw std::runtime_error("Unknown records file format: " + path_.string());
+        }
+
+        size_t offset = sizeof(FILE_MAGIC);
+        RecordHeader header;
+        while (ReadRecord(data, region_.get_size(), offset, header)) {
+            offset = Align(offset + header.length);
+            ++count_;
+        }
+        end_ = std::min(offset, region_.get_size());
+
+        // после оборванной записи следующие дописываются поверх, старые байты не должны читаться как запись
+        char* tail = static_cast<char*>(region_.get_address()) + end_;
+        const size_t tail_size = region_.get_size() - end_;
+        if (std::any_of(tail, tail + tail_size, [](char c) { return c != 0; })) {
+            std::memset(tail, 0, tail_size);
+            region_.flush(end_, tail_size, false);
+        }
+    }
+
+    FileRecordStore::~FileRecordStore() {
+        region_.flush(0, 0, false);
+    }
+
+    void FileRecordStore::WriteRecords(const std::vector<GameRecords>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        size_t required = 0;
+        for (const GameRecords& gr : records) {
+            required += Align(sizeof(RecordHeader) + gr.name.size());
+        }
+
+        std::lock_guard lock(mutex_);
+        if (end_ + required > region_.get_size()) {
+            Grow(end_ + required);
+        }
+
+        char* data = static_cast<char*>(region_.get_address());
+        const size_t start = end_;
+        for (const GameRecords& gr : records) {
+            RecordHeader header;
+            header.length = static_cast<std::uint32_t>(sizeof(RecordHeader) + gr.name.size());
+            header.score = gr.score;
+            // время округляется к ближайшему, как при записи в базу
+            header.play_time_ms = std::llrint(gr.played_time);
+            header.checksum = Checksum(header.score, header.play_time_ms, gr.name.data(), gr.name.size());
+
+            std::memcpy(data + end_, &header, sizeof(RecordHeader));
+            std::memcpy(data + end_ + sizeof(RecordHeader), gr.name.data(), gr.name.size());
+            end_ = Align(end_ + header.length);
+        }
+        count_ += records.size();
+        // сброс на диск идет в фоне; при падении процесса страницы все равно остаются в кэше ОС
+        region_.flush(start, end_ - start, true);
+    }
+
+    void FileRecordStore::ReadAllRecords(const RecordHandler& fn) {
+        std::lock_guard lock(mutex_);
+
+        const char* data = static_cast<const char*>(region_.get_address());
+        RecordHeader header;
+        for (size_t offset = sizeof(FILE_MAGIC); offset < end_; offset = Align(offset + header.length)) {
+            std::memcpy(&header, data + offset, sizeof(RecordHeader));
+            fn(std::string(data + offset + sizeof(RecordHeader), header.length - sizeof(RecordHeader)),
+                header.score, header.play_time_ms);
+        }
+    }
+
+    size_t FileRecordStore::Size() const {
+        std::lock_guard lock(mutex_);
+        return count_;
+    }
+
+    void FileRecordStore::Map() {
+        file_ = ipc::file_mapping(path_.string().c_str(), ipc::read_write);
+        region_ = ipc::mapped_region(file_, ipc::read_write);
+    }
+
+    void FileRecordStore::Grow(size_t required) {
+        size_t capacity = std::max<size_t>(region_.get_size(), INITIAL_CAPACITY);
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        region_.flush(0, 0, false);
+        region_ = ipc::mapped_region();
+        // новое место в файле заполняется нулями
+        std::filesystem::resize_file(path_, capacity);
+        Map();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <filesystem>
+#include <mutex>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "record_store.h"
+
+namespace db {
+
+    /*
+     * Встроенное хранилище рекордов без внешних сервисов: журнал в файле, который только дописывается
+     * и целиком отображен в память. Запись пачки - копирование в отображение и асинхронный сброс
+     * на диск, без системных вызовов на каждую запись.
+     * Формат: 8 байт сигнатуры, затем записи с выравниванием на 8 байт -
+     * длина, контрольная сумма, очки, время в мс (числа в порядке байт машины) и имя.
+     * Хвост с неверной контрольной суммой (оборванная при падении запись) при открытии отбрасывается.
+     * Файл растет удвоением, свободное место в конце заполнено нулями.
+     */
+    class FileRecordStore : public RecordStore {
+    public:
+        explicit FileRecordStore(std::filesystem::path path);
+        ~FileRecordStore() override;
+
+        FileRecordStore(const FileRecordStore&) = delete;
+        FileRecordStore& operator=(const FileRecordStore&) = delete;
+
+        void WriteRecords(const std::vector<GameRecords>& records) override;
+        void ReadAllRecords(const RecordHandler& fn) override;
+
+        size_t Size() const;
+
+    private:
+        void Map();
+        void Grow(size_t required);
+
+        mutable std::mutex mutex_;
+        std::filesystem::path path_;
+        boost::interprocess::file_mapping file_;
+        boost::interprocess::mapped_region region_;
+        // конец последней целой записи
+        size_t end_ = 0;
+        size_t count_ = 0;
+    };
+}
@@ -0,0 +1,183 @@
+#include <charconv>
+#include <cmath>
+#include "json_writer.h"
+
+namespace wire {
+
+void JsonWriter::Separator() {
+    if (need_comma_) {
+        out_.push_back(',');
+    }
+}
+
+void JsonWriter::BeginObject(size_t) {
+    Separator();
+    out_.push_back('{');
+    need_comma_ = false;
+}
+
+void JsonWriter::EndObject() {
+    out_.push_back('}');
+    need_comma_ = true;
+}
+
+void JsonWriter::BeginArray(size_t) {
+    Separator();
+    out_.push_back('[');
+    need_comma_ = false;
+}
+
+void JsonWriter::EndArray() {
+    out_.push_back(']');
+    need_comma_ = true;
+}
+
+void JsonWriter::Key(std::string_view key) {
+    Separator();
+    Escaped(key);
+    out_.push_back(':');
+    need_comma_ = false;
+}
+
+void JsonWriter::NumberKey(std::uint64_t key) {
+    Separator();
+    char buffer[24];
+    buffer[0] = '"';
+    auto [end, ec] = std::to_chars(buffer + 1, buffer + sizeof(buffer) - 2, key);
+    *end++ = '"';
+    *end++ = ':';
+    out_.append(buffer, end);
+    need_comma_ = false;
+}
+
+void JsonWriter::Null() {
+    Separator();
+    out_.append("null");
+    need_comma_ = true;
+}
+
+void JsonWriter::Bool(bool value) {
+    Separator();
+    out_.append(value ? "true" : "false");
+    need_comma_ = true;
+}
+
+void JsonWriter::Uint(std::uint64_t value) {
+    Separator();
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+    need_comma_ = true;
+}
+
+void JsonWriter::Int(std::int64_t value) {
+    Separator();
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+    need_comma_ = true;
+}
+
+void JsonWriter::Double(double value) {
+    if (!std::isfinite(value)) {
+        Null();
+        return;
+    }
+    Separator();
+    // кратчайшая запись, которая читается обратно в то же число
+    char buffer[32];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+    need_comma_ = true;
+}
+
+void JsonWriter::String(std::string_view value) {
+    Separator();
+    Escaped(value);
+    need_comma_ = true;
+}
+
+void JsonWriter::Escaped(std::string_view value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    out_.push_back('"');
+    size_t run_start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // обычные символы копируются кусками
+        out_.append(value.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+        case '"':
+            out_.append("\\\"");
+            break;
+        case '\\':
+            out_.append("\\\\");
+            break;
+        case '\b':
+            out_.append("\\b");
+            break;
+        case '\f':
+            out_.append("\\f");
+            break;
+        case '\n':
+            out_.append("\\n");
+            break;
+        case '\r':
+            out_.append("\\r");
+            break;
+        case '\t':
+            out_.append("\\t");
+            break;
+        default: {
+            const char escaped[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0x0f] };
+            out_.append(escaped, sizeof(escaped));
+        }
+        }
+    }
+    out_.append(value.data() + run_start, value.size() - run_start);
+    out_.push_back('"');
+}
+
+void JsonWriter::Json(const boost::json::value& value) {
+    switch (value.kind()) {
+    case boost::json::kind::null:
+        Null();
+        break;
+    case boost::json::kind::bool_:
+        Bool(value.get_bool());
+        break;
+    case boost::json::kind::int64:
+        Int(value.get_int64());
+        break;
+    case boost::json::kind::uint64:
+        Uint(value.get_uint64());
+        break;
+    case boost::json::kind::double_:
+        Double(value.get_double());
+        break;
+    case boost::json::kind::string:
+        String(value.get_string());
+        break;
+    case boost::json::kind::array:
+        BeginArray();
+        for (const auto& item : value.get_array()) {
+            Json(item);
+        }
+        EndArray();
+        break;
+    case boost::json::kind::object:
+        BeginObject();
+        for (const auto& item : value.get_object()) {
+            Key(item.key());
+            Json(item.value());
+        }
+        EndObject();
+        break;
+    }
+}
+
+}  // wire
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <boost/json.hpp>
+
+namespace wire {
+
+/*
+ * Потоковая запись JSON в конец строки без промежуточного дерева boost::json.
+ * Запятые расставляются сами, пробелов нет, строки экранируются как в boost::json::serialize.
+ * double печатается кратчайшим представлением через std::to_chars, не-конечные числа - как null.
+ * Размеры в BeginObject/BeginArray не нужны JSON, они есть для общего с MsgPackWriter кода.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out)
+        : out_(out) {
+    }
+
+    void BeginObject(size_t size = 0);
+    void EndObject();
+    void BeginArray(size_t size = 0);
+    void EndArray();
+
+    void Key(std::string_view key);
+    // числовой ключ, как идентификаторы игроков в ответах
+    void NumberKey(std::uint64_t key);
+
+    void Null();
+    void Bool(bool value);
+    void Uint(std::uint64_t value);
+    void Int(std::int64_t value);
+    void Double(double value);
+    void String(std::string_view value);
+    void Json(const boost::json::value& value);
+
+private:
+    void Separator();
+    void Escaped(std::string_view value);
+
+    std::string& out_;
+    // следующему значению или ключу нужна запятая
+    bool need_comma_ = false;
+};
+
+}  // wire
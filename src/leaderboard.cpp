@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+#include "leaderboard.h"
+
+namespace db {
+
+    namespace {
+
+        // splitmix64: приоритеты детерминированы и не зависят от порядка ключей
+        std::uint64_t MixPriority(std::uint64_t value) {
+            value += 0x9e3779b97f4a7c15ull;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+    }
+
+    void Leaderboard::Add(const std::string& name, std::uint64_t score, std::int64_t play_time_ms) {
+        std::unique_lock lock(mutex_);
+
+        const auto index = static_cast<std::int32_t>(nodes_.size());
+        nodes_.push_back({ name, score, play_time_ms, MixPriority(nodes_.size()) });
+
+        // равные записи встают после уже добавленных
+        std::int32_t left = NO_NODE;
+        std::int32_t right = NO_NODE;
+        Split(root_, nodes_[index], left, right);
+        root_ = Merge(Merge(left, index), right);
+
+        auto [best, inserted] = best_by_name_.emplace(name, index);
+        if (!inserted && Before(nodes_[index], nodes_[best->second])) {
+            best->second = index;
+        }
+    }
+
+    std::vector<GameRecords> Leaderboard::GetPage(size_t offset, size_t count) const {
+        std::shared_lock lock(mutex_);
+        return CollectPage(offset, count);
+    }
+
+    std::vector<GameRecords> Leaderboard::GetPageAfter(const RecordCursor& cursor, size_t count) const {
+        Node key{ cursor.name, cursor.score, cursor.play_time_ms, 0 };
+
+        std::shared_lock lock(mutex_);
+        return CollectPage(CountNotAfter(key), count);
+    }
+
+    std::optional<Leaderboard::Rank> Leaderboard::FindRank(const std::string& name) const {
+        std::shared_lock lock(mutex_);
+
+        auto best = best_by_name_.find(name);
+        if (best == best_by_name_.end()) {
+            return std::nullopt;
+        }
+        const Node& node = nodes_[best->second];
+        return Rank{ CountBefore(node) + 1, ToRecord(node) };
+    }
+
+    size_t Leaderboard::Size() const {
+        std::shared_lock lock(mutex_);
+        return nodes_.size();
+    }
+
+    bool Leaderboard::Before(const Node& lhs, const Node& rhs) {
+        // std::string сравнивает байты как unsigned char, то есть как COLLATE "C" в PostgreSQL
+        return std::tie(rhs.score, lhs.play_time_ms, lhs.name) < std::tie(lhs.score, rhs.play_time_ms, rhs.name);
+    }
+
+    GameRecords Leaderboard::ToRecord(const Node& node) {
+        return { node.name, static_cast<size_t>(node.score), static_cast<double>(node.play_time_ms) / 1000 };
+    }
+
+    std::uint32_t Leaderboard::SubtreeSize(std::int32_t node) const {
+        return node == NO_NODE ? 0 : nodes_[node].size;
+    }
+
+    void Leaderboard::Update(std::int32_t node) {
+        nodes_[node].size = 1 + SubtreeSize(nodes_[node].left) + SubtreeSize(nodes_[node].right);
+    }
+
+    void Leaderboard::Split(std::int32_t node, const Node& key, std::int32_t& left, std::int32_t& right) {
+        if (node == NO_NODE) {
+            left = right = NO_NODE;
+            return;
+        }
+        if (Before(key, nodes_[node])) {
+            Split(nodes_[node].left, key, left, nodes_[node].left);
+            right = node;
+        }
+        else {
+            Split(nodes_[node].right, key, nodes_[node].right, right);
+            left = node;
+        }
+        Update(node);
+    }
+
+    std::int32_t Leaderboard::Merge(std::int32_t left, std::int32_t right) {
+        if (left == NO_NODE) {
+            return right;
+        }
+        if (right == NO_NODE) {
+            return left;
+        }
+        if (nodes_[left].priority > nodes_[right].priority) {
+            nodes_[left].right = Merge(nodes_[left].right, right);
+            Update(left);
+            return left;
+        }
+        nodes_[right].left = Merge(left, nodes_[right].left);
+        Update(right);
+        return right;
+    }
+
+    void Leaderboard::Collect(std::int32_t node, size_t& skip, size_t& count, std::vector<GameRecords>& out) const {
+        if (node == NO_NODE || count == 0) {
+            return;
+        }
+        // поддерево целиком до начала страницы
+        if (skip >= nodes_[node].size) {
+            skip -= nodes_[node].size;
+            return;
+        }
+        Collect(nodes_[node].left, skip, count, out);
+        if (count == 0) {
+            return;
+        }
+        if (skip > 0) {
+            --skip;
+        }
+        else {
+            out.push_back(ToRecord(nodes_[node]));
+            --count;
+        }
+        Collect(nodes_[node].right, skip, count, out);
+    }
+
+    std::vector<GameRecords> Leaderboard::CollectPage(size_t offset, size_t count) const {
+        std::vector<GameRecords> page;
+        if (offset >= SubtreeSize(root_)) {
+            return page;
+        }
+        page.reserve(std::min(count, SubtreeSize(root_) - offset));
+        Collect(root_, offset, count, page);
+        return page;
+    }
+
+    size_t Leaderboard::CountBefore(const Node& key) const {
+        size_t count = 0;
+        std::int32_t node = root_;
+        while (node != NO_NODE) {
+            if (Before(nodes_[node], key)) {
+                count += SubtreeSize(nodes_[node].left) + 1;
+                node = nodes_[node].right;
+            }
+            else {
+                node = nodes_[node].left;
+            }
+        }
+        return count;
+    }
+
+    size_t Leaderboard::CountNotAfter(const Node& key) const {
+        size_t count = 0;
+        std::int32_t node = root_;
+        while (node != NO_NODE) {
+            if (!Before(key, nodes_[node])) {
+                count += SubtreeSize(nodes_[node].left) + 1;
+                node = nodes_[node].right;
+            }
+            else {
+                node = nodes_[node].left;
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "database_addition_struct.h"
+
+namespace db {
+
+    /*
+     * Таблица рекордов в памяти: очки по убыванию, затем время игры и имя по возрастанию.
+     * Имена сравниваются побайтно, как при COLLATE "C"; индекс retired_players_play_time_ms_name_idx
+     * упорядочен по правилам сортировки базы, поэтому при равных очках и времени порядок может отличаться.
+     * Декартово дерево с размерами поддеревьев: страница и место по имени находятся
+     * за O(log n + k) без обращения к базе. Записи только добавляются.
+     * Читать можно из любого потока, добавление берет исключительную блокировку.
+     */
+    class Leaderboard {
+    public:
+        struct Rank {
+            // место с 1
+            size_t place;
+            GameRecords record;
+        };
+
+        void Add(const std::string& name, std::uint64_t score, std::int64_t play_time_ms);
+
+        // как SELECT ... ORDER BY score DESC, play_time_ms, name COLLATE "C" LIMIT count OFFSET offset
+        std::vector<GameRecords> GetPage(size_t offset, size_t count) const;
+        // count записей строго после cursor; cursor не обязан быть в таблице
+        std::vector<GameRecords> GetPageAfter(const RecordCursor& cursor, size_t count) const;
+        // лучший результат игрока с таким именем
+        std::optional<Rank> FindRank(const std::string& name) const;
+        size_t Size() const;
+
+    private:
+        static constexpr std::int32_t NO_NODE = -1;
+
+        struct Node {
+            std::string name;
+            std::uint64_t score;
+            std::int64_t play_time_ms;
+            std::uint64_t priority;
+            std::int32_t left = NO_NODE;
+            std::int32_t right = NO_NODE;
+            std::uint32_t size = 1;
+        };
+
+        static bool Before(const Node& lhs, const Node& rhs);
+        static GameRecords ToRecord(const Node& node);
+
+        std::uint32_t SubtreeSize(std::int32_t node) const;
+        void Update(std::int32_t node);
+        // left - узлы не позже key, right - остальные
+        void Split(std::int32_t node, const Node& key, std::int32_t& left, std::int32_t& right);
+        std::int32_t Merge(std::int32_t left, std::int32_t right);
+        void Collect(std::int32_t node, size_t& skip, size_t& count, std::vector<GameRecords>& out) const;
+        size_t CountBefore(const Node& key) const;
+        size_t CountNotAfter(const Node& key) const;
+        std::vector<GameRecords> CollectPage(size_t offset, size_t count) const;
+
+        mutable std::shared_mutex mutex_;
+        // узлы в одном векторе, ссылки - индексы
+        std::vector<Node> nodes_;
+        std::int32_t root_ = NO_NODE;
+        std::unordered_map<std::string, std::int32_t> best_by_name_;
+    };
+}
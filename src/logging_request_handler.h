@@ -45,7 +45,8 @@ namespace server_logger {
                 std::visit([&](auto&& response_data) {
                     using ResponseType = std::decay_t<decltype(response_data)>;
                     if constexpr (std::is_same_v<http_handler::StringResponse, ResponseType> ||
-                        std::is_same_v<http_handler::FileResponse, ResponseType>) {
+                        std::is_same_v<http_handler::FileResponse, ResponseType> ||
+                        std::is_same_v<http_handler::SharedStringResponse, ResponseType>) {
                         log_and_send(std::forward<decltype(response_data)>(response_data));
                     }
                     }, resp);
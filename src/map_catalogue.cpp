@@ -0,0 +1,76 @@
+#include <cstdint>
+#include "map_catalogue.h"
+#include "state_encoding.h"
+
+namespace api_handler {
+
+    MapCatalogue::MapCatalogue(const app::Application& apl) {
+        list_[static_cast<size_t>(BodyFormat::Json)] = MakeEntry(encoding::EncodeMapsJson(apl.GetMaps()));
+        list_[static_cast<size_t>(BodyFormat::MsgPack)] = MakeEntry(encoding::EncodeMapsMsgPack(apl.GetMaps()));
+
+        for (const auto& map : apl.GetMaps()) {
+            const auto& loot_types = apl.GetTrophies(*map.GetId());
+            Entries& entries = maps_[*map.GetId()];
+            entries[static_cast<size_t>(BodyFormat::Json)] = MakeEntry(encoding::EncodeMapJson(map, loot_types));
+            entries[static_cast<size_t>(BodyFormat::MsgPack)] = MakeEntry(encoding::EncodeMapMsgPack(map, loot_types));
+        }
+    }
+
+    const MapCatalogue::Entry& MapCatalogue::GetList(BodyFormat format) const {
+        return list_[static_cast<size_t>(format)];
+    }
+
+    const MapCatalogue::Entry* MapCatalogue::FindMap(const std::string& id, BodyFormat format) const {
+        auto it = maps_.find(id);
+        return it == maps_.end() ? nullptr : &it->second[static_cast<size_t>(format)];
+    }
+
+    bool MapCatalogue::MatchesETag(std::string_view if_none_match, std::string_view etag) {
+        auto trim = [](std::string_view str) {
+            while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+                str.remove_prefix(1);
+            }
+            while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+                str.remove_suffix(1);
+            }
+            return str;
+        };
+
+        if (trim(if_none_match) == "*") {
+            return true;
+        }
+        while (!if_none_match.empty()) {
+            size_t comma = if_none_match.find(',');
+            std::string_view tag = trim(if_none_match.substr(0, comma));
+            if (tag.substr(0, 2) == "W/") {
+                tag.remove_prefix(2);
+            }
+            if (tag == etag) {
+                return true;
+            }
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            if_none_match.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+    MapCatalogue::Entry MapCatalogue::MakeEntry(std::string body) {
+        // FNV-1a по байтам тела
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char c : body) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+
+        static constexpr char HEX[] = "0123456789abcdef";
+        std::string etag(18, '"');
+        for (size_t i = 0; i < 16; ++i) {
+            etag[16 - i] = HEX[hash & 0x0f];
+            hash >>= 4;
+        }
+
+        return { std::make_shared<const std::string>(std::move(body)), std::move(etag) };
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "app.h"
+
+namespace api_handler {
+
+    // формат тела ответа, выбирается по заголовку Accept; ошибки всегда в JSON
+    enum class BodyFormat { Json, MsgPack };
+
+    constexpr size_t BODY_FORMATS_COUNT = 2;
+
+    /*
+     * Ответы /api/v1/maps и /api/v1/maps/{id}, собранные один раз при запуске:
+     * после загрузки конфигурации карты не меняются. Тело отдается без копирования,
+     * ETag - хэш байтов тела, поэтому он свой для каждого формата.
+     */
+    class MapCatalogue {
+    public:
+        struct Entry {
+            std::shared_ptr<const std::string> body;
+            std::string etag;
+        };
+
+        explicit MapCatalogue(const app::Application& apl);
+
+        const Entry& GetList(BodyFormat format) const;
+        // nullptr, если карты нет
+        const Entry* FindMap(const std::string& id, BodyFormat format) const;
+
+        // If-None-Match совпадает с ETag (сравнение слабое, как требует RFC 9110)
+        static bool MatchesETag(std::string_view if_none_match, std::string_view etag);
+
+    private:
+        using Entries = std::array<Entry, BODY_FORMATS_COUNT>;
+
+        static Entry MakeEntry(std::string body);
+
+        Entries list_;
+        std::unordered_map<std::string, Entries> maps_;
+    };
+}
@@ -137,7 +137,10 @@ const std::string Dog::GetName() const {
 }
 
 void Dog::SetPosition(const Position& position) {
-    pos_ = position;
+    if (pos_ != position) {
+        pos_ = position;
+        ++revision_;
+    }
 }
 
 const Position Dog::GetPosition() const {
@@ -149,11 +152,17 @@ const int Dog::GetBagCapacity() const {
 }
 
 void Dog::SetSpeed(Speed spd) {
-    speed_ = spd;
+    if (speed_ != spd) {
+        speed_ = spd;
+        ++revision_;
+    }
 }
 
 void Dog::AddScore(int sc) {
-    score_ += sc;
+    if (sc != 0) {
+        score_ += sc;
+        ++revision_;
+    }
 }
 
 const Speed Dog::GetSpeed() const {
@@ -161,7 +170,10 @@ const Speed Dog::GetSpeed() const {
 }
 
 void Dog::SetDirection(Direction dir) {
-    dir_ = dir;
+    if (dir_ != dir) {
+        dir_ = dir;
+        ++revision_;
+    }
 }
 
 const Direction Dog::GetDirection() const {
@@ -170,6 +182,7 @@ const Direction Dog::GetDirection() const {
 
 void Dog::AddItemToBag(Trophy trophy) {
     bag_.push_back(trophy);
+    ++revision_;
 }
 
 const std::vector<Trophy> Dog::GetItemFromBag() const {
@@ -184,7 +197,10 @@ void Dog::ReturnTrophyToOffice() {
     for (const auto& trophy : bag_) {
         AddScore(trophy.GetType());
     }
-    bag_.clear();
+    if (!bag_.empty()) {
+        bag_.clear();
+        ++revision_;
+    }
 }
 
 const size_t Dog::GetScore() const {
@@ -243,6 +259,9 @@ const double Dog::GetStayTime() {
 void Dog::EraseStayTime() {
     stay_time = 0;
 }
+std::uint64_t Dog::GetRevision() const {
+    return revision_;
+}
 // end dog
 
 //session
@@ -267,6 +286,10 @@ std::map<int, Dog*>& GameSession::GetDogs() {
     return dogs_;
 }
 
+const std::map<int, Dog*>& GameSession::GetDogs() const {
+    return dogs_;
+}
+
 const size_t GameSession::GetCountTrophyOnMap() const {
     return trophy_.size();
 }
@@ -301,9 +324,24 @@ void GameSession::DeleteDog(const Dog* dog) {
     id = ptr_to_id.at(dog);
     if (id != -1) {
         dogs_.erase(id);
+        active_dogs_.erase(id);
         ptr_to_id.erase(dog);
     }
 }
+
+void GameSession::SetDogActive(const Dog* dog, bool active) {
+    const int id = ptr_to_id.at(dog);
+    if (active) {
+        active_dogs_[id] = dogs_.at(id);
+    }
+    else {
+        active_dogs_.erase(id);
+    }
+}
+
+std::map<int, Dog*>& GameSession::GetActiveDogs() {
+    return active_dogs_;
+}
 //end session
 
 //game
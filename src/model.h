@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <iostream>
@@ -284,6 +285,8 @@ public:
     void UpdateStayTime(double time);
     const double GetStayTime();
     void EraseStayTime();
+    // растет при каждом изменении того, что видит клиент: позиции, скорости, направления, рюкзака, очков
+    std::uint64_t GetRevision() const;
 
     bool operator==(const Dog& other) const {
         return name_ == other.name_; 
@@ -299,6 +302,7 @@ private:
     size_t score_ = 0;
     double played_time = 0;
     double stay_time = 0;
+    std::uint64_t revision_ = 0;
 };
 
 class GameSession {
@@ -317,6 +321,7 @@ public:
     void AddDogToSession(const Dog& dog);
     Dog* GetLastDog() ;
     std::map<int, Dog*>& GetDogs();
+    const std::map<int, Dog*>& GetDogs() const;
     const size_t GetCountTrophyOnMap() const;
     void AddTrophyOnMap(const Trophy& tr);
     const size_t GetCountDogOnMap() const;
@@ -325,11 +330,15 @@ public:
     const Trophy GetTrophy(int id) const;
     void RemoveTrophy(int id);
     void DeleteDog(const Dog* dog);
+    // активные собаки двигаются и участвуют в расчете столкновений
+    void SetDogActive(const Dog* dog, bool active);
+    std::map<int, Dog*>& GetActiveDogs();
 
 private:
     const Map* map_;
     std::list<Dog> dog_base_;
     std::map<int, Dog*> dogs_;
+    std::map<int, Dog*> active_dogs_;
     std::unordered_map<const Dog*, int> ptr_to_id;
     int trophy_added_ = 0;
     std::unordered_map<size_t, Trophy> trophy_;
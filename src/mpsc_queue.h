@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace util {
+
+/*
+ * Неограниченная lock-free очередь с многими писателями и одним читателем (схема Вьюкова).
+ * Push можно вызывать из любых потоков, TryPop - только из одного потока-читателя.
+ * Элементы одного писателя извлекаются в порядке добавления.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : head_(new Node)
+        , tail_(head_.load(std::memory_order_relaxed)) {
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        T value;
+        while (TryPop(value)) {
+        }
+        delete tail_;
+    }
+
+    void Push(T value) {
+        Node* node = new Node;
+        node->value.emplace(std::move(value));
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // false, если очередь пуста или писатель еще не успел связать свой узел
+    bool TryPop(T& value) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(*next->value);
+        next->value.reset();
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        std::optional<T> value;
+    };
+
+    // сюда добавляют писатели
+    std::atomic<Node*> head_;
+    // отсюда читает читатель, узел tail_ - пустышка
+    Node* tail_;
+};
+
+}  // util
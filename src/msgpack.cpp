@@ -0,0 +1,412 @@
+#include <cstring>
+#include <limits>
+#include "msgpack.h"
+
+namespace wire {
+
+template <typename T>
+void MsgPackWriter::BigEndian(std::uint8_t tag, T value) {
+    // байты собираются вручную, результат не зависит от порядка байт машины
+    char bytes[1 + sizeof(T)];
+    bytes[0] = static_cast<char>(tag);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bytes[sizeof(T) - i] = static_cast<char>(value & 0xff);
+        value = static_cast<T>(value >> 8);
+    }
+    out_.append(bytes, sizeof(bytes));
+}
+
+void MsgPackWriter::Nil() {
+    out_.push_back(static_cast<char>(0xc0));
+}
+
+void MsgPackWriter::Bool(bool value) {
+    out_.push_back(static_cast<char>(value ? 0xc3 : 0xc2));
+}
+
+void MsgPackWriter::Uint(std::uint64_t value) {
+    if (value < 0x80) {
+        out_.push_back(static_cast<char>(value));
+    }
+    else if (value <= std::numeric_limits<std::uint8_t>::max()) {
+        BigEndian<std::uint8_t>(0xcc, static_cast<std::uint8_t>(value));
+    }
+    else if (value <= std::numeric_limits<std::uint16_t>::max()) {
+        BigEndian<std::uint16_t>(0xcd, static_cast<std::uint16_t>(value));
+    }
+    else if (value <= std::numeric_limits<std::uint32_t>::max()) {
+        BigEndian<std::uint32_t>(0xce, static_cast<std::uint32_t>(value));
+    }
+    else {
+        BigEndian<std::uint64_t>(0xcf, value);
+    }
+}
+
+void MsgPackWriter::Int(std::int64_t value) {
+    if (value >= 0) {
+        Uint(static_cast<std::uint64_t>(value));
+    }
+    else if (value >= -32) {
+        out_.push_back(static_cast<char>(value));
+    }
+    else if (value >= std::numeric_limits<std::int8_t>::min()) {
+        BigEndian<std::uint8_t>(0xd0, static_cast<std::uint8_t>(value));
+    }
+    else if (value >= std::numeric_limits<std::int16_t>::min()) {
+        BigEndian<std::uint16_t>(0xd1, static_cast<std::uint16_t>(value));
+    }
+    else if (value >= std::numeric_limits<std::int32_t>::min()) {
+        BigEndian<std::uint32_t>(0xd2, static_cast<std::uint32_t>(value));
+    }
+    else {
+        BigEndian<std::uint64_t>(0xd3, static_cast<std::uint64_t>(value));
+    }
+}
+
+void MsgPackWriter::Double(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    BigEndian<std::uint64_t>(0xcb, bits);
+}
+
+void MsgPackWriter::String(std::string_view value) {
+    const size_t size = value.size();
+    if (size < 32) {
+        out_.push_back(static_cast<char>(0xa0 | size));
+    }
+    else if (size <= std::numeric_limits<std::uint8_t>::max()) {
+        BigEndian<std::uint8_t>(0xd9, static_cast<std::uint8_t>(size));
+    }
+    else if (size <= std::numeric_limits<std::uint16_t>::max()) {
+        BigEndian<std::uint16_t>(0xda, static_cast<std::uint16_t>(size));
+    }
+    else {
+        BigEndian<std::uint32_t>(0xdb, static_cast<std::uint32_t>(size));
+    }
+    out_.append(value);
+}
+
+void MsgPackWriter::ArrayHeader(size_t size) {
+    if (size < 16) {
+        out_.push_back(static_cast<char>(0x90 | size));
+    }
+    else if (size <= std::numeric_limits<std::uint16_t>::max()) {
+        BigEndian<std::uint16_t>(0xdc, static_cast<std::uint16_t>(size));
+    }
+    else {
+        BigEndian<std::uint32_t>(0xdd, static_cast<std::uint32_t>(size));
+    }
+}
+
+void MsgPackWriter::MapHeader(size_t size) {
+    if (size < 16) {
+        out_.push_back(static_cast<char>(0x80 | size));
+    }
+    else if (size <= std::numeric_limits<std::uint16_t>::max()) {
+        BigEndian<std::uint16_t>(0xde, static_cast<std::uint16_t>(size));
+    }
+    else {
+        BigEndian<std::uint32_t>(0xdf, static_cast<std::uint32_t>(size));
+    }
+}
+
+void MsgPackWriter::Json(const boost::json::value& value) {
+    switch (value.kind()) {
+    case boost::json::kind::null:
+        Nil();
+        break;
+    case boost::json::kind::bool_:
+        Bool(value.get_bool());
+        break;
+    case boost::json::kind::int64:
+        Int(value.get_int64());
+        break;
+    case boost::json::kind::uint64:
+        Uint(value.get_uint64());
+        break;
+    case boost::json::kind::double_:
+        Double(value.get_double());
+        break;
+    case boost::json::kind::string:
+        String(value.get_string());
+        break;
+    case boost::json::kind::array:
+        ArrayHeader(value.get_array().size());
+        for (const auto& item : value.get_array()) {
+            Json(item);
+        }
+        break;
+    case boost::json::kind::object:
+        MapHeader(value.get_object().size());
+        for (const auto& item : value.get_object()) {
+            String(item.key());
+            Json(item.value());
+        }
+        break;
+    }
+}
+
+std::uint8_t MsgPackReader::Tag() const {
+    if (AtEnd()) {
+        throw MsgPackError("unexpected end of msgpack data");
+    }
+    return static_cast<std::uint8_t>(data_[pos_]);
+}
+
+template <typename T>
+T MsgPackReader::ReadBigEndian() {
+    std::string_view bytes = Take(sizeof(T));
+    T value = 0;
+    for (char byte : bytes) {
+        value = static_cast<T>((value << 8) | static_cast<std::uint8_t>(byte));
+    }
+    return value;
+}
+
+std::string_view MsgPackReader::Take(size_t size) {
+    if (data_.size() - pos_ < size) {
+        throw MsgPackError("unexpected end of msgpack data");
+    }
+    std::string_view result = data_.substr(pos_, size);
+    pos_ += size;
+    return result;
+}
+
+MsgPackReader::Type MsgPackReader::Peek() const {
+    const std::uint8_t tag = Tag();
+    if (tag <= 0x7f) {
+        return Type::Uint;
+    }
+    if (tag <= 0x8f) {
+        return Type::Map;
+    }
+    if (tag <= 0x9f) {
+        return Type::Array;
+    }
+    if (tag <= 0xbf) {
+        return Type::String;
+    }
+    if (tag >= 0xe0) {
+        return Type::Int;
+    }
+    switch (tag) {
+    case 0xc0:
+        return Type::Nil;
+    case 0xc2:
+    case 0xc3:
+        return Type::Bool;
+    case 0xca:
+    case 0xcb:
+        return Type::Double;
+    case 0xcc:
+    case 0xcd:
+    case 0xce:
+    case 0xcf:
+        return Type::Uint;
+    case 0xd0:
+    case 0xd1:
+    case 0xd2:
+    case 0xd3:
+        return Type::Int;
+    case 0xd9:
+    case 0xda:
+    case 0xdb:
+        return Type::String;
+    case 0xdc:
+    case 0xdd:
+        return Type::Array;
+    case 0xde:
+    case 0xdf:
+        return Type::Map;
+    default:
+        throw MsgPackError("unsupported msgpack type");
+    }
+}
+
+void MsgPackReader::ReadNil() {
+    if (Tag() != 0xc0) {
+        throw MsgPackError("msgpack nil expected");
+    }
+    ++pos_;
+}
+
+bool MsgPackReader::ReadBool() {
+    const std::uint8_t tag = Tag();
+    if (tag != 0xc2 && tag != 0xc3) {
+        throw MsgPackError("msgpack bool expected");
+    }
+    ++pos_;
+    return tag == 0xc3;
+}
+
+std::uint64_t MsgPackReader::ReadUint() {
+    const std::uint8_t tag = Tag();
+    if (tag <= 0x7f) {
+        ++pos_;
+        return tag;
+    }
+    ++pos_;
+    switch (tag) {
+    case 0xcc:
+        return ReadBigEndian<std::uint8_t>();
+    case 0xcd:
+        return ReadBigEndian<std::uint16_t>();
+    case 0xce:
+        return ReadBigEndian<std::uint32_t>();
+    case 0xcf:
+        return ReadBigEndian<std::uint64_t>();
+    default:
+        --pos_;
+        throw MsgPackError("msgpack unsigned integer expected");
+    }
+}
+
+std::int64_t MsgPackReader::ReadInt() {
+    const std::uint8_t tag = Tag();
+    if (tag >= 0xe0) {
+        ++pos_;
+        return static_cast<std::int8_t>(tag);
+    }
+    switch (tag) {
+    case 0xd0:
+        ++pos_;
+        return static_cast<std::int8_t>(ReadBigEndian<std::uint8_t>());
+    case 0xd1:
+        ++pos_;
+        return static_cast<std::int16_t>(ReadBigEndian<std::uint16_t>());
+    case 0xd2:
+        ++pos_;
+        return static_cast<std::int32_t>(ReadBigEndian<std::uint32_t>());
+    case 0xd3:
+        ++pos_;
+        return static_cast<std::int64_t>(ReadBigEndian<std::uint64_t>());
+    default: {
+        const std::uint64_t value = ReadUint();
+        if (value > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            throw MsgPackError("msgpack integer is out of range");
+        }
+        return static_cast<std::int64_t>(value);
+    }
+    }
+}
+
+double MsgPackReader::ReadDouble() {
+    switch (Peek()) {
+    case Type::Double:
+        break;
+    case Type::Uint:
+        return static_cast<double>(ReadUint());
+    case Type::Int:
+        return static_cast<double>(ReadInt());
+    default:
+        throw MsgPackError("msgpack number expected");
+    }
+
+    const std::uint8_t tag = Tag();
+    ++pos_;
+    if (tag == 0xca) {
+        const std::uint32_t bits = ReadBigEndian<std::uint32_t>();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    const std::uint64_t bits = ReadBigEndian<std::uint64_t>();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string_view MsgPackReader::ReadString() {
+    const std::uint8_t tag = Tag();
+    size_t size = 0;
+    if (tag >= 0xa0 && tag <= 0xbf) {
+        ++pos_;
+        size = tag & 0x1f;
+    }
+    else if (tag == 0xd9) {
+        ++pos_;
+        size = ReadBigEndian<std::uint8_t>();
+    }
+    else if (tag == 0xda) {
+        ++pos_;
+        size = ReadBigEndian<std::uint16_t>();
+    }
+    else if (tag == 0xdb) {
+        ++pos_;
+        size = ReadBigEndian<std::uint32_t>();
+    }
+    else {
+        throw MsgPackError("msgpack string expected");
+    }
+    return Take(size);
+}
+
+size_t MsgPackReader::ReadArrayHeader() {
+    const std::uint8_t tag = Tag();
+    if (tag >= 0x90 && tag <= 0x9f) {
+        ++pos_;
+        return tag & 0x0f;
+    }
+    if (tag == 0xdc) {
+        ++pos_;
+        return ReadBigEndian<std::uint16_t>();
+    }
+    if (tag == 0xdd) {
+        ++pos_;
+        return ReadBigEndian<std::uint32_t>();
+    }
+    throw MsgPackError("msgpack array expected");
+}
+
+size_t MsgPackReader::ReadMapHeader() {
+    const std::uint8_t tag = Tag();
+    if (tag >= 0x80 && tag <= 0x8f) {
+        ++pos_;
+        return tag & 0x0f;
+    }
+    if (tag == 0xde) {
+        ++pos_;
+        return ReadBigEndian<std::uint16_t>();
+    }
+    if (tag == 0xdf) {
+        ++pos_;
+        return ReadBigEndian<std::uint32_t>();
+    }
+    throw MsgPackError("msgpack map expected");
+}
+
+void MsgPackReader::Skip() {
+    switch (Peek()) {
+    case Type::Nil:
+        ReadNil();
+        break;
+    case Type::Bool:
+        ReadBool();
+        break;
+    case Type::Uint:
+        ReadUint();
+        break;
+    case Type::Int:
+        ReadInt();
+        break;
+    case Type::Double:
+        ReadDouble();
+        break;
+    case Type::String:
+        ReadString();
+        break;
+    case Type::Array:
+        for (size_t i = ReadArrayHeader(); i > 0; --i) {
+            Skip();
+        }
+        break;
+    case Type::Map:
+        for (size_t i = ReadMapHeader(); i > 0; --i) {
+            Skip();
+            Skip();
+        }
+        break;
+    }
+}
+
+}  // wire
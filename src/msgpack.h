@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <boost/json.hpp>
+
+namespace wire {
+
+/*
+ * Запись значений в формате MessagePack (https://msgpack.org) в конец строки.
+ * Числа и длины всегда кодируются самым коротким вариантом, double - как float64.
+ * Строка принадлежит вызывающему, ее можно очищать и переиспользовать между ответами.
+ */
+class MsgPackWriter {
+public:
+    explicit MsgPackWriter(std::string& out)
+        : out_(out) {
+    }
+
+    void Nil();
+    void Bool(bool value);
+    void Uint(std::uint64_t value);
+    void Int(std::int64_t value);
+    void Double(double value);
+    void String(std::string_view value);
+    void ArrayHeader(size_t size);
+    void MapHeader(size_t size);
+
+    // те же вызовы, что у JsonWriter, чтобы структуру ответа можно было описать один раз
+    void BeginObject(size_t size) {
+        MapHeader(size);
+    }
+    void EndObject() {
+    }
+    void BeginArray(size_t size) {
+        ArrayHeader(size);
+    }
+    void EndArray() {
+    }
+    void Key(std::string_view key) {
+        String(key);
+    }
+
+    // объект JSON записывается как map, порядок ключей сохраняется
+    void Json(const boost::json::value& value);
+
+private:
+    template <typename T>
+    void BigEndian(std::uint8_t tag, T value);
+
+    std::string& out_;
+};
+
+class MsgPackError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/*
+ * Последовательное чтение MessagePack без построения дерева.
+ * При неожиданном типе или обрыве данных бросает MsgPackError, bin и ext не поддерживаются.
+ */
+class MsgPackReader {
+public:
+    enum class Type { Nil, Bool, Uint, Int, Double, String, Array, Map };
+
+    explicit MsgPackReader(std::string_view data)
+        : data_(data) {
+    }
+
+    bool AtEnd() const {
+        return pos_ == data_.size();
+    }
+
+    Type Peek() const;
+
+    void ReadNil();
+    bool ReadBool();
+    std::uint64_t ReadUint();
+    std::int64_t ReadInt();
+    // целые тоже читаются как double
+    double ReadDouble();
+    // ссылается на исходные данные
+    std::string_view ReadString();
+    size_t ReadArrayHeader();
+    size_t ReadMapHeader();
+
+    // пропускает значение вместе с вложенными
+    void Skip();
+
+private:
+    std::uint8_t Tag() const;
+    template <typename T>
+    T ReadBigEndian();
+    std::string_view Take(size_t size);
+
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+}  // wire
@@ -14,6 +14,12 @@ namespace command_line {
         bool random_position = false;
         std::string save_path = "";
         int save_time_period = 0;
+        bool event_simulation = false;
+        unsigned tick_threads = 0;
+        bool split_sessions = false;
+        size_t tick_phases = 1;
+        size_t max_catch_up = 4;
+        std::string records_file;
     };
 
     [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
@@ -29,7 +35,13 @@ namespace command_line {
             ("www-root,w", po::value(&args.web_folder)->value_name("folder"s), "Directory with frontend game data")
             ("randomize-spawn-points", po::bool_switch(&args.random_position)->value_name("bool"), "spawn dogs at random positions")
             ("state-file", po::value(&args.save_path)->value_name("path"), "Path to file for saving date")
-            ("save-state-period", po::value(&args.save_time_period)->value_name("miliseconds"), "Period between state saving");
+            ("save-state-period", po::value(&args.save_time_period)->value_name("miliseconds"), "Period between state saving")
+            ("event-simulation", po::bool_switch(&args.event_simulation)->value_name("bool"), "event-driven movement and collisions")
+            ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "Threads for parallel session update")
+            ("split-large-sessions", po::bool_switch(&args.split_sessions)->value_name("bool"), "update large sessions on all tick threads")
+            ("tick-phases", po::value(&args.tick_phases)->value_name("count"s), "Spread session updates over phases of the tick period")
+            ("max-catch-up", po::value(&args.max_catch_up)->value_name("periods"s), "Max tick periods to catch up after a stall")
+            ("records-file", po::value(&args.records_file)->value_name("path"s), "Keep records in an embedded file instead of PostgreSQL");
 
         
         po::variables_map vm;
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "rcu.h"
+
+namespace util {
+
+EpochDomain::~EpochDomain() {
+    for (auto& retired : retired_) {
+        retired.deleter();
+    }
+}
+
+EpochDomain::Guard EpochDomain::Enter() {
+    // разные потоки начинают поиск свободного слота с разных мест
+    const size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % SLOTS_COUNT;
+    for (;;) {
+        for (size_t i = 0; i < SLOTS_COUNT; ++i) {
+            const size_t slot = (start + i) % SLOTS_COUNT;
+            std::uint64_t expected = 0;
+            if (slots_[slot].epoch.compare_exchange_strong(expected, epoch_.load(std::memory_order_seq_cst),
+                std::memory_order_seq_cst)) {
+                return Guard(this, slot);
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochDomain::Leave(size_t slot) {
+    slots_[slot].epoch.store(0, std::memory_order_release);
+}
+
+void EpochDomain::Retire(std::function<void()> deleter) {
+    retired_.push_back({ epoch_.load(std::memory_order_relaxed), std::move(deleter) });
+}
+
+void EpochDomain::Advance() {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+
+    if (retired_.empty()) {
+        return;
+    }
+
+    std::uint64_t min_active = UINT64_MAX;
+    for (const auto& slot : slots_) {
+        const std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) {
+            min_active = std::min(min_active, epoch);
+        }
+    }
+
+    // объект, замененный в эпохе e, мог достаться только читателям с эпохой не больше e
+    auto alive = std::partition(retired_.begin(), retired_.end(), [min_active](const Retired& retired) {
+        return retired.epoch >= min_active;
+    });
+    for (auto it = alive; it != retired_.end(); ++it) {
+        it->deleter();
+    }
+    retired_.erase(alive, retired_.end());
+}
+
+}  // util
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/*
+ * Освобождение памяти по эпохам для схемы RCU.
+ * Читатель на время чтения занимает слот и записывает в него текущую эпоху. Писатель
+ * (он один) не удаляет замененный объект сразу, а откладывает его с пометкой эпохи и
+ * удаляет, когда ни один читатель не остался в этой или более ранней эпохе.
+ * Чтение не блокируется писателем и не трогает счетчики ссылок.
+ */
+class EpochDomain {
+public:
+    static constexpr size_t SLOTS_COUNT = 256;
+
+    // слот читателя, пока он жив, объекты текущей эпохи не удаляются
+    class Guard {
+    public:
+        Guard(Guard&& other) noexcept
+            : domain_(std::exchange(other.domain_, nullptr))
+            , slot_(other.slot_) {
+        }
+        Guard& operator=(Guard&&) = delete;
+        Guard(const Guard&) = delete;
+
+        ~Guard() {
+            if (domain_) {
+                domain_->Leave(slot_);
+            }
+        }
+
+    private:
+        friend class EpochDomain;
+        Guard(EpochDomain* domain, size_t slot)
+            : domain_(domain)
+            , slot_(slot) {
+        }
+
+        EpochDomain* domain_;
+        size_t slot_;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+    ~EpochDomain();
+
+    Guard Enter();
+
+    // вызывается только писателем
+    void Retire(std::function<void()> deleter);
+    // переводит эпоху и удаляет объекты, которые больше никто не читает
+    void Advance();
+
+    size_t RetiredCount() const {
+        return retired_.size();
+    }
+
+private:
+    // 0 - слот свободен, иначе эпоха читателя
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{ 0 };
+    };
+
+    struct Retired {
+        std::uint64_t epoch;
+        std::function<void()> deleter;
+    };
+
+    void Leave(size_t slot);
+
+    std::atomic<std::uint64_t> epoch_{ 1 };
+    std::array<Slot, SLOTS_COUNT> slots_;
+    std::vector<Retired> retired_;
+};
+
+/*
+ * Ячейка с неизменяемым объектом, который писатель заменяет целиком.
+ * Load можно вызывать из любого потока внутри EpochDomain::Guard того же домена.
+ */
+template <typename T>
+class RcuCell {
+public:
+    explicit RcuCell(EpochDomain& domain)
+        : domain_(domain) {
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ~RcuCell() {
+        delete value_.load(std::memory_order_relaxed);
+    }
+
+    const T* Load() const {
+        return value_.load(std::memory_order_seq_cst);
+    }
+
+    // вызывается только писателем
+    void Publish(std::unique_ptr<const T> value) {
+        const T* old = value_.exchange(value.release(), std::memory_order_seq_cst);
+        if (old != nullptr) {
+            domain_.Retire([old] { delete old; });
+        }
+    }
+
+private:
+    EpochDomain& domain_;
+    std::atomic<const T*> value_{ nullptr };
+};
+
+}  // util
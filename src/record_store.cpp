@@ -0,0 +1,36 @@
+#include "database.h"
+#include "file_record_store.h"
+#include "record_store.h"
+
+namespace db {
+
+    namespace {
+
+        // PostgreSQL; запросы выполняются в вызывающем потоке - это уже фоновый RecordWriter или запуск сервера.
+        // Если все соединения заняты дольше DBSetting::connection_wait, вызов завершается db_conn::PoolTimeout
+        class PostgresRecordStore : public RecordStore {
+        public:
+            explicit PostgresRecordStore(const DBSetting& dbs)
+                : db_{ dbs } {
+            }
+
+            void WriteRecords(const std::vector<GameRecords>& records) override {
+                db_.WriteRecords(records);
+            }
+
+            void ReadAllRecords(const RecordHandler& fn) override {
+                db_.ReadAllRecords(fn);
+            }
+
+        private:
+            Database db_;
+        };
+    }
+
+    std::unique_ptr<RecordStore> MakeRecordStore(const std::string& db_url, const std::string& records_file) {
+        if (!records_file.empty()) {
+            return std::make_unique<FileRecordStore>(records_file);
+        }
+        return std::make_unique<PostgresRecordStore>(DBSetting{ db_url, MAX_DB_CONNECTION });
+    }
+}
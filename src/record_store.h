@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "database_addition_struct.h"
+
+namespace db {
+
+    /*
+     * Хранилище рекордов ушедших на пенсию собак. Приложению нужно только дописывать пачки
+     * и один раз при запуске прочитать все записи в таблицу рекордов в памяти (Leaderboard),
+     * которая дальше и служит отсортированным индексом.
+     * WriteRecords вызывается из потока RecordWriter, ReadAllRecords - при запуске, до первой записи.
+     */
+    class RecordStore {
+    public:
+        using RecordHandler = std::function<void(std::string name, std::uint64_t score, std::int64_t play_time_ms)>;
+
+        virtual ~RecordStore() = default;
+
+        // played_time записей в миллисекундах
+        virtual void WriteRecords(const std::vector<GameRecords>& records) = 0;
+        // все записи в порядке добавления
+        virtual void ReadAllRecords(const RecordHandler& fn) = 0;
+    };
+
+    // непустой records_file - встроенное хранилище в этом файле, иначе PostgreSQL по db_url
+    std::unique_ptr<RecordStore> MakeRecordStore(const std::string& db_url, const std::string& records_file);
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include "record_writer.h"
+
+namespace db {
+
+    RecordWriter::RecordWriter(Flush flush)
+        : RecordWriter(std::move(flush), Config{}) {
+    }
+
+    RecordWriter::RecordWriter(Flush flush, Config config)
+        : flush_{ std::move(flush) }
+        , config_{ config }
+        , thread_{ [this] { Run(); } } {
+    }
+
+    RecordWriter::~RecordWriter() {
+        Stop();
+    }
+
+    void RecordWriter::SetHandlers(ErrorHandler error_handler, StatsHandler stats_handler) {
+        std::lock_guard lock{ mutex_ };
+        error_handler_ = std::move(error_handler);
+        stats_handler_ = std::move(stats_handler);
+    }
+
+    void RecordWriter::Enqueue(GameRecords record) {
+        bool full = false;
+        {
+            std::lock_guard lock{ mutex_ };
+            queue_.push_back(std::move(record));
+            ++stats_.queue_depth;
+            full = queue_.size() >= config_.batch_size;
+        }
+        if (full) {
+            cond_var_.notify_one();
+        }
+    }
+
+    void RecordWriter::Stop() {
+        {
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        cond_var_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    RecordWriterStats RecordWriter::GetStats() const {
+        std::lock_guard lock{ mutex_ };
+        return stats_;
+    }
+
+    void RecordWriter::Run() {
+        std::unique_lock lock{ mutex_ };
+        while (true) {
+            // после ошибки ждем полный интервал, иначе до заполнения пачки
+            cond_var_.wait_for(lock, config_.flush_interval, [this] {
+                return stop_ || (!retry_ && queue_.size() >= config_.batch_size);
+            });
+            retry_ = false;
+
+            if (queue_.empty()) {
+                if (stop_) {
+                    return;
+                }
+                continue;
+            }
+            FlushBatch(lock);
+
+            // при остановке повторная ошибка не ждет: записи теряются
+            if (stop_ && retry_) {
+                const size_t lost = queue_.size();
+                queue_.clear();
+                stats_.queue_depth = 0;
+                ErrorHandler error_handler = error_handler_;
+                lock.unlock();
+                if (error_handler) {
+                    error_handler(std::runtime_error("records dropped on shutdown"), lost);
+                }
+                else {
+                    std::cerr << "records dropped on shutdown: " << lost << '\n';
+                }
+                return;
+            }
+        }
+    }
+
+    void RecordWriter::FlushBatch(std::unique_lock<std::mutex>& lock) {
+        const size_t size = std::min(queue_.size(), config_.batch_size);
+        std::vector<GameRecords> batch(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + size));
+        queue_.erase(queue_.begin(), queue_.begin() + size);
+        lock.unlock();
+
+        const auto start = Clock::now();
+        std::exception_ptr error;
+        try {
+            flush_(batch);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+
+        lock.lock();
+        ++stats_.flushes;
+        stats_.last_flush_latency = latency;
+        stats_.max_flush_latency = std::max(stats_.max_flush_latency, latency);
+        if (error) {
+            ++stats_.failed_flushes;
+            queue_.insert(queue_.begin(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+            retry_ = true;
+        }
+        else {
+            stats_.written += batch.size();
+            stats_.queue_depth -= batch.size();
+        }
+
+        const auto now = Clock::now();
+        const bool report = stats_handler_ && now - last_report_ >= config_.report_period;
+        if (report) {
+            last_report_ = now;
+        }
+        ErrorHandler error_handler = error_handler_;
+        StatsHandler stats_handler = report ? stats_handler_ : StatsHandler{};
+        const RecordWriterStats stats = stats_;
+
+        // handler'ы вызываются без блокировки, чтобы не задерживать Enqueue
+        lock.unlock();
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e) {
+                if (error_handler) {
+                    error_handler(e, batch.size());
+                }
+                else {
+                    std::cerr << e.what() << '\n';
+                }
+            }
+            catch (...) {
+                std::cerr << "unknown record flush error" << '\n';
+            }
+        }
+        if (stats_handler) {
+            stats_handler(stats);
+        }
+        lock.lock();
+    }
+}
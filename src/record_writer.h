@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "database_addition_struct.h"
+
+namespace db {
+
+    struct RecordWriterStats {
+        // записи, ожидающие записи в базу, вместе с пишущейся пачкой
+        size_t queue_depth = 0;
+        std::uint64_t written = 0;
+        std::uint64_t flushes = 0;
+        std::uint64_t failed_flushes = 0;
+        std::chrono::milliseconds last_flush_latency{ 0 };
+        std::chrono::milliseconds max_flush_latency{ 0 };
+    };
+
+    /*
+     * Отложенная запись рекордов ушедших на пенсию собак (write-behind).
+     * Enqueue только кладет запись в очередь, фоновый поток пишет пачками: как только набралось
+     * batch_size записей или прошло flush_interval с прошлой записи. После ошибки пачка
+     * возвращается в начало очереди и пишется повторно через flush_interval.
+     * Stop дописывает очередь и останавливает поток.
+     */
+    class RecordWriter {
+    public:
+        using Flush = std::function<void(const std::vector<GameRecords>& batch)>;
+        using ErrorHandler = std::function<void(const std::exception& e, size_t batch_size)>;
+        using StatsHandler = std::function<void(const RecordWriterStats& stats)>;
+
+        struct Config {
+            size_t batch_size = 256;
+            std::chrono::milliseconds flush_interval{ 200 };
+            // не чаще этого интервала статистика передается в stats_handler
+            std::chrono::milliseconds report_period{ 10000 };
+        };
+
+        explicit RecordWriter(Flush flush);
+        RecordWriter(Flush flush, Config config);
+        ~RecordWriter();
+
+        RecordWriter(const RecordWriter&) = delete;
+        RecordWriter& operator=(const RecordWriter&) = delete;
+
+        // handler'ы вызываются в потоке записи
+        void SetHandlers(ErrorHandler error_handler, StatsHandler stats_handler);
+
+        void Enqueue(GameRecords record);
+        // дописывает очередь; если база недоступна, оставшиеся записи теряются с вызовом error_handler
+        void Stop();
+
+        RecordWriterStats GetStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void Run();
+        void FlushBatch(std::unique_lock<std::mutex>& lock);
+
+        const Flush flush_;
+        const Config config_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cond_var_;
+        std::deque<GameRecords> queue_;
+        bool stop_ = false;
+        bool retry_ = false;
+        RecordWriterStats stats_;
+        ErrorHandler error_handler_;
+        StatsHandler stats_handler_;
+        Clock::time_point last_report_ = Clock::now();
+
+        std::thread thread_;
+    };
+}
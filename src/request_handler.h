@@ -15,18 +15,17 @@ namespace http_handler {
 
     using StringResponse = http::response<http::string_body>;
     using FileResponse = http::response<http::file_body>;
-    using Response = std::variant<StringResponse, FileResponse>;
+    using SharedStringResponse = http_server::SharedStringResponse;
+    using Response = std::variant<StringResponse, FileResponse, SharedStringResponse>;
 
 
     class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
     public:
 
-        using Strand = net::strand<net::io_context::executor_type>;      
-
-        explicit RequestHandler(app::Application& apl, std::filesystem::path root, Strand api_strand)
+        RequestHandler(app::Application& apl, app::Simulation& sim, std::filesystem::path root,
+            net::any_io_executor response_executor)
             : root_(std::move(root))
-            , api_strand_{ api_strand }
-            , apiHandlerPtr_{ std::make_shared<api_handler::ApiHandler>(apl) }
+            , apiHandlerPtr_{ std::make_shared<api_handler::ApiHandler>(apl, sim, std::move(response_executor)) }
         { }
 
         RequestHandler(const RequestHandler&) = delete;
@@ -39,16 +38,15 @@ namespace http_handler {
 
             if (req_string.find("/api/") != std::string::npos) {
 
-                net::dispatch(api_strand_, [self = shared_from_this(), req = std::forward<decltype(req)>(req), version, send]{
-                    try {
-                        assert(self->api_strand_.running_in_this_thread());
-                        send(std::move(self->apiHandlerPtr_->GetApiResponse(std::move(req))));
-                        }
-                    catch (std::exception) {
-                        send(std::move(self->apiHandlerPtr_->GetErrorResponse(version, http::status::bad_request,
-                            api_handler::BAD_REQUEST)));
-                        }
-                });
+                // чтение идет из снимка мира, изменения уходят командами в поток симуляции,
+                // поэтому запрос обрабатывается прямо в потоке ввода-вывода
+                try {
+                    apiHandlerPtr_->HandleApiRequest(std::move(req), send);
+                }
+                catch (std::exception) {
+                    send(std::move(apiHandlerPtr_->GetErrorResponse(version, http::status::bad_request,
+                        api_handler::BAD_REQUEST)));
+                }
             }
             else { //this case for file or error not file
                 if (req_string.back() == '/') {
@@ -70,7 +68,6 @@ namespace http_handler {
     private:
         std::shared_ptr<api_handler::ApiHandler> apiHandlerPtr_;
         const std::filesystem::path root_;
-        Strand api_strand_;
 
         FileResponse GetFileResponse(const std::string& str, unsigned http_version) const;
         std::string_view GetMimeType(std::string_view path) const;
@@ -0,0 +1,80 @@
+#include "session_changes.h"
+
+namespace app {
+
+    bool SessionChangeTracker::Stamp(SessionSnapshot& snapshot) {
+        const std::uint64_t tick = snapshot.tick;
+        bool changed = !started_;
+        if (!started_) {
+            // до первой публикации истории нет, клиенту со старым тиком нужен полный снимок
+            started_ = true;
+            history_from_ = tick;
+        }
+        ++round_;
+
+        for (auto& player : snapshot.players) {
+            auto [it, inserted] = players_.try_emplace(player.id, PlayerEntry{ player.revision, tick, round_ });
+            PlayerEntry& entry = it->second;
+            if (!inserted && entry.revision != player.revision) {
+                entry.revision = player.revision;
+                entry.changed_tick = tick;
+                changed = true;
+            }
+            changed = changed || inserted;
+            entry.seen = round_;
+            player.changed_tick = entry.changed_tick;
+        }
+
+        for (auto& loot : snapshot.loot) {
+            auto [it, inserted] = loot_.try_emplace(loot.id, LootEntry{ tick, round_ });
+            it->second.seen = round_;
+            changed = changed || inserted;
+            loot.spawned_tick = it->second.spawned_tick;
+        }
+
+        // чего нет в новом снимке, то удалено на этом тике
+        for (auto it = players_.begin(); it != players_.end();) {
+            if (it->second.seen != round_) {
+                Remove({ tick, RemovedEntity::Kind::Player, static_cast<size_t>(it->first) });
+                it = players_.erase(it);
+                changed = true;
+            }
+            else {
+                ++it;
+            }
+        }
+        for (auto it = loot_.begin(); it != loot_.end();) {
+            if (it->second.seen != round_) {
+                Remove({ tick, RemovedEntity::Kind::Loot, it->first });
+                it = loot_.erase(it);
+                changed = true;
+            }
+            else {
+                ++it;
+            }
+        }
+
+        TrimHistory(tick);
+
+        if (!removed_published_) {
+            removed_published_ = std::make_shared<const std::vector<RemovedEntity>>(removed_.begin(), removed_.end());
+        }
+        snapshot.removed = removed_published_;
+        snapshot.history_from = history_from_;
+        return changed;
+    }
+
+    void SessionChangeTracker::Remove(RemovedEntity entity) {
+        removed_.push_back(entity);
+        removed_published_.reset();
+    }
+
+    void SessionChangeTracker::TrimHistory(std::uint64_t tick) {
+        while (!removed_.empty() && removed_.front().tick + HISTORY_TICKS < tick) {
+            // удаления этого тика забыты, разницу от него уже не посчитать
+            history_from_ = removed_.front().tick + 1;
+            removed_.pop_front();
+            removed_published_.reset();
+        }
+    }
+}
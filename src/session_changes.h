@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "world_snapshot.h"
+
+namespace app {
+
+    /*
+     * Отслеживает изменения сущностей одной сессии между публикациями снимков.
+     * Игрок считается измененным, если выросла ревизия его собаки, предмет - в момент появления.
+     * Удаления хранятся HISTORY_TICKS тиков, клиенту, который отстал сильнее, отдается полный снимок.
+     */
+    class SessionChangeTracker {
+    public:
+        static constexpr std::uint64_t HISTORY_TICKS = 256;
+
+        // проставляет тики изменений в снимке, который собирается к публикации;
+        // false - с прошлого снимка ничего не изменилось и публиковать его незачем
+        bool Stamp(SessionSnapshot& snapshot);
+
+    private:
+        struct PlayerEntry {
+            std::uint64_t revision;
+            std::uint64_t changed_tick;
+            std::uint64_t seen;
+        };
+
+        struct LootEntry {
+            std::uint64_t spawned_tick;
+            std::uint64_t seen;
+        };
+
+        void Remove(RemovedEntity entity);
+        void TrimHistory(std::uint64_t tick);
+
+        bool started_ = false;
+        std::uint64_t round_ = 0;
+        std::uint64_t history_from_ = 0;
+        std::unordered_map<int, PlayerEntry> players_;
+        std::unordered_map<size_t, LootEntry> loot_;
+        std::deque<RemovedEntity> removed_;
+        // общий для снимков список удалений, пересобирается только при изменении
+        std::shared_ptr<const std::vector<RemovedEntity>> removed_published_;
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+
+namespace http_server {
+
+    namespace net = boost::asio;
+    namespace beast = boost::beast;
+    namespace http = beast::http;
+
+    /*
+     * Тело ответа, которое не копируется: несколько ответов держат одну строку по счетчику ссылок.
+     * Используется только для отправки.
+     */
+    struct SharedStringBody {
+        using value_type = std::shared_ptr<const std::string>;
+
+        static std::uint64_t size(const value_type& body) {
+            return body ? body->size() : 0;
+        }
+
+        class writer {
+        public:
+            using const_buffers_type = net::const_buffer;
+
+            template <bool isRequest, typename Fields>
+            writer(const http::header<isRequest, Fields>&, const value_type& body)
+                : body_(body) {
+            }
+
+            void init(beast::error_code& ec) {
+                ec = {};
+            }
+
+            boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+                ec = {};
+                if (!body_ || body_->empty()) {
+                    return boost::none;
+                }
+                return std::make_pair(const_buffers_type(body_->data(), body_->size()), false);
+            }
+
+        private:
+            const value_type& body_;
+        };
+    };
+
+    using SharedStringResponse = http::response<SharedStringBody>;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace timer {
+
+    namespace net = boost::asio;
+    namespace sys = boost::system;
+
+    struct SchedulerStats {
+        // выполненные шаги по фазам
+        std::uint64_t steps = 0;
+        // пробуждения, на которых шаг опоздал больше, чем на интервал между фазами
+        std::uint64_t overruns = 0;
+        // периоды, пропущенные из-за ограничения на догон
+        std::uint64_t dropped_periods = 0;
+        std::chrono::milliseconds max_lateness{ 0 };
+    };
+
+    /*
+     * Планировщик симуляции с фиксированным шагом.
+     * Период делится на phases фаз, фаза k выполняется в момент start + n * period + k * period / phases,
+     * и handler получает в ней ровно period игрового времени. Сроки абсолютные, поэтому время работы
+     * handler не накапливается в дрейф. Если планировщик отстал, пропущенные шаги догоняются подряд,
+     * но не больше max_catch_up периодов за одно пробуждение, остальные периоды отбрасываются.
+     */
+    class SimulationScheduler : public std::enable_shared_from_this<SimulationScheduler> {
+    public:
+
+        using Strand = net::strand<net::io_context::executor_type>;
+        using Handler = std::function<void(std::chrono::milliseconds step, size_t phase, size_t phases)>;
+        using ErrorHandler = std::function<void(const std::exception& e)>;
+        using StatsHandler = std::function<void(const SchedulerStats& stats)>;
+
+        struct Config {
+            std::chrono::milliseconds period;
+            size_t phases = 1;
+            size_t max_catch_up = 4;
+            // не чаще этого интервала статистика передается в stats_handler, если в ней есть опоздания
+            std::chrono::milliseconds report_period{ 10000 };
+        };
+
+        // handler, error_handler и stats_handler вызываются внутри strand
+        SimulationScheduler(Strand strand, Config config, Handler handler,
+            ErrorHandler error_handler = {}, StatsHandler stats_handler = {})
+            : strand_{ strand }
+            , config_{ std::move(config) }
+            , handler_{ std::move(handler) }
+            , error_handler_{ std::move(error_handler) }
+            , stats_handler_{ std::move(stats_handler) } {
+            config_.phases = std::max<size_t>(config_.phases, 1);
+            config_.max_catch_up = std::max<size_t>(config_.max_catch_up, 1);
+            phase_interval_ = std::chrono::duration_cast<Clock::duration>(config_.period) / config_.phases;
+        }
+
+        void Start() {
+            net::dispatch(strand_, [self = shared_from_this()]{
+                self->next_deadline_ = Clock::now() + self->phase_interval_;
+                self->last_report_ = Clock::now();
+                self->ScheduleTick();
+                });
+        }
+
+        // копия статистики, вызывать внутри strand
+        SchedulerStats GetStats() const {
+            return stats_;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void ScheduleTick() {
+            assert(strand_.running_in_this_thread());
+            timer_.expires_at(next_deadline_);
+            timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
+                self->OnTick(ec);
+            });
+        }
+
+        void OnTick(sys::error_code ec) {
+            using namespace std::chrono;
+            assert(strand_.running_in_this_thread());
+
+            if (ec) {
+                return;
+            }
+
+            const auto now = Clock::now();
+            const auto lateness = now - next_deadline_;
+            if (lateness >= phase_interval_) {
+                ++stats_.overruns;
+            }
+            stats_.max_lateness = std::max(stats_.max_lateness, duration_cast<milliseconds>(lateness));
+
+            // догоняем пропущенные фазы, но не больше max_catch_up периодов
+            const size_t max_steps = config_.max_catch_up * config_.phases;
+            size_t done = 0;
+            while (next_deadline_ <= now && done < max_steps) {
+                RunStep();
+                ++done;
+            }
+
+            if (next_deadline_ <= now) {
+                // отброшенные периоды целиком, чтобы у каждой сессии сохранилась своя фаза
+                const auto period = phase_interval_ * config_.phases;
+                const auto behind = (now - next_deadline_) / period + 1;
+                next_deadline_ += period * behind;
+                phase_number_ += config_.phases * behind;
+                stats_.dropped_periods += behind;
+            }
+
+            Report(now);
+            ScheduleTick();
+        }
+
+        void RunStep() {
+            const size_t phase = phase_number_ % config_.phases;
+            ++phase_number_;
+            next_deadline_ += phase_interval_;
+            ++stats_.steps;
+            try {
+                handler_(config_.period, phase, config_.phases);
+            }
+            catch (const std::exception& e) {
+                if (error_handler_) {
+                    error_handler_(e);
+                }
+            }
+        }
+
+        void Report(Clock::time_point now) {
+            if (!stats_handler_ || now - last_report_ < config_.report_period) {
+                return;
+            }
+            if (stats_.overruns != reported_.overruns || stats_.dropped_periods != reported_.dropped_periods) {
+                stats_handler_(stats_);
+                reported_ = stats_;
+            }
+            last_report_ = now;
+        }
+
+    private:
+        Strand strand_;
+        Config config_;
+        net::steady_timer timer_{ strand_ };
+        Handler handler_;
+        ErrorHandler error_handler_;
+        StatsHandler stats_handler_;
+        Clock::duration phase_interval_;
+        Clock::time_point next_deadline_;
+        Clock::time_point last_report_;
+        std::uint64_t phase_number_ = 0;
+        SchedulerStats stats_;
+        SchedulerStats reported_;
+    };
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <iterator>
+#include "simulation.h"
+
+namespace app {
+
+    Simulation::Simulation(Application& apl)
+        : apl_{ apl }
+        , apply_on_submit_{ apl.isSelfMode() }
+        , strand_{ net::make_strand(ioc_) }
+        , work_{ net::make_work_guard(ioc_) } {
+        std::vector<Deferred> nothing;
+        Publish(nothing);
+    }
+
+    Simulation::~Simulation() {
+        Stop();
+    }
+
+    Simulation::Strand Simulation::GetStrand() const {
+        return strand_;
+    }
+
+    void Simulation::Start() {
+        net::dispatch(strand_, [this] {
+            RunCommands();
+        });
+        thread_ = std::thread([this] {
+            ioc_.run();
+        });
+    }
+
+    void Simulation::Stop() {
+        work_.reset();
+        ioc_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Simulation::Submit(Command command) {
+        commands_.Push(std::move(command));
+        // при обновлении по таймеру очередь разбирает следующий тик
+        if (apply_on_submit_ && !wake_pending_.exchange(true)) {
+            net::post(strand_, [this] {
+                wake_pending_ = false;
+                RunCommands();
+            });
+        }
+    }
+
+    void Simulation::Tick(std::chrono::milliseconds step, size_t phase, size_t phases) {
+        ApplyCommands(deferred_);
+        apl_.UpdateWorldPhase(step.count(), phase, phases);
+        Publish(deferred_);
+    }
+
+    Simulation::SessionView Simulation::ReadSession(const std::string& token) const {
+        util::EpochDomain::Guard guard = epochs_.Enter();
+        const TokenDirectory* directory = directory_.Load();
+        const SessionCell* cell = directory->Find(token);
+        const SessionSnapshot* session = cell ? cell->Load() : nullptr;
+        return SessionView(std::move(guard), session);
+    }
+
+    std::vector<bool> Simulation::HasTokens(const std::vector<std::string>& tokens) const {
+        util::EpochDomain::Guard guard = epochs_.Enter();
+        const TokenDirectory* directory = directory_.Load();
+        std::vector<bool> result;
+        result.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            result.push_back(directory->Find(token) != nullptr);
+        }
+        return result;
+    }
+
+    void Simulation::WaitNextSnapshot(const std::string& token, std::uint64_t after, std::chrono::milliseconds timeout,
+        SessionWaiter waiter) {
+        Submit([this, token, after, timeout, waiter = std::move(waiter)]() -> Deferred {
+            const SessionCell* cell = directory_.Load()->Find(token);
+            // игрок ушел или сессия изменилась, пока команда ждала в очереди
+            if (cell == nullptr || cell->Load()->version > after) {
+                return [this, token, waiter] {
+                    waiter(ReadSession(token));
+                };
+            }
+
+            auto timer = std::make_shared<net::steady_timer>(strand_, timeout);
+            timer->async_wait([this, cell, timer = timer.get()](const boost::system::error_code& ec) {
+                if (!ec) {
+                    OnWaitTimeout(cell, timer);
+                }
+            });
+            parked_[cell].push_back({ after, waiter, std::move(timer) });
+            return {};
+        });
+    }
+
+    void Simulation::ApplyCommands(std::vector<Deferred>& deferred) {
+        Command command;
+        while (commands_.TryPop(command)) {
+            try {
+                if (Deferred action = command()) {
+                    deferred.push_back(std::move(action));
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            catch (...) {
+                std::cerr << "unknown command error" << '\n';
+            }
+        }
+    }
+
+    void Simulation::RunCommands() {
+        ApplyCommands(deferred_);
+        Publish(deferred_);
+    }
+
+    void Simulation::Publish(std::vector<Deferred>& deferred) {
+        // сначала сессии: справочник токенов должен ссылаться на уже опубликованные ячейки.
+        // Снимок пересобирается только у сессий, которые изменили тик или команды, остальные
+        // ячейки сохраняют прежний снимок, поэтому публикация не зависит от размера мира
+        for (const model::GameSession* session : apl_.TakeChangedSessions()) {
+            PublishedSession& published = sessions_[session];
+            if (!published.cell) {
+                published.cell = std::make_unique<SessionCell>(epochs_);
+            }
+            auto snapshot = apl_.MakeSessionSnapshot(*session);
+            // шаг мог не сдвинуть ни одной собаки: тогда остаются прежний снимок, его версия и кэши тел
+            if (!published.changes.Stamp(*snapshot)) {
+                continue;
+            }
+            const std::uint64_t version = snapshot->version = ++published.version;
+            published.cell->Publish(std::move(snapshot));
+            WakeWaiters(published.cell.get(), version, deferred);
+        }
+
+        if (!directory_published_ || directory_version_ != apl_.GetPlayersVersion()) {
+            auto directory = std::make_unique<TokenDirectory>();
+            for (const auto& [id, player] : apl_.GetPlayersList()) {
+                directory->sessions.emplace(*player->GetToken(), sessions_.at(player->GetSession()).cell.get());
+            }
+            directory_.Publish(std::move(directory));
+            directory_version_ = apl_.GetPlayersVersion();
+            directory_published_ = true;
+        }
+
+        epochs_.Advance();
+
+        // ответы уходят после публикации, чтобы следующий запрос клиента увидел свои изменения
+        for (auto& action : deferred) {
+            try {
+                action();
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+        }
+        deferred.clear();
+    }
+
+    void Simulation::WakeWaiters(const SessionCell* cell, std::uint64_t version, std::vector<Deferred>& deferred) {
+        auto parked = parked_.find(cell);
+        if (parked == parked_.end()) {
+            return;
+        }
+
+        std::vector<ParkedWaiter> ready;
+        auto& waiters = parked->second;
+        auto it = std::partition(waiters.begin(), waiters.end(), [version](const ParkedWaiter& parked_waiter) {
+            return parked_waiter.after >= version;
+        });
+        std::move(it, waiters.end(), std::back_inserter(ready));
+        waiters.erase(it, waiters.end());
+        if (waiters.empty()) {
+            parked_.erase(parked);
+        }
+        if (ready.empty()) {
+            return;
+        }
+
+        // все ожидающие получают один и тот же снимок, поэтому полное тело ответа собирается один раз
+        deferred.push_back([this, cell, ready = std::move(ready)] {
+            for (const auto& parked_waiter : ready) {
+                parked_waiter.timer->cancel();
+                parked_waiter.waiter(SessionView(epochs_.Enter(), cell->Load()));
+            }
+        });
+    }
+
+    void Simulation::OnWaitTimeout(const SessionCell* cell, const net::steady_timer* timer) {
+        auto parked = parked_.find(cell);
+        if (parked == parked_.end()) {
+            return;
+        }
+        auto& waiters = parked->second;
+        auto it = std::find_if(waiters.begin(), waiters.end(), [timer](const ParkedWaiter& parked_waiter) {
+            return parked_waiter.timer.get() == timer;
+        });
+        // запрос мог быть разбужен публикацией раньше таймера
+        if (it == waiters.end()) {
+            return;
+        }
+        SessionWaiter waiter = std::move(it->waiter);
+        waiters.erase(it);
+        if (waiters.empty()) {
+            parked_.erase(parked);
+        }
+        waiter(SessionView(epochs_.Enter(), cell->Load()));
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include "app.h"
+#include "mpsc_queue.h"
+#include "session_changes.h"
+
+namespace app {
+
+    namespace net = boost::asio;
+
+    /*
+     * Отдельный поток, которому принадлежит игровой мир.
+     * HTTP-потоки не трогают модель: изменения передаются командами через lock-free очередь,
+     * а чтение идет из снимков сессий, которые поток симуляции публикует после применения команд и тика;
+     * заново публикуются только сессии, измененные с прошлой публикации.
+     * При обновлении по таймеру команды применяются в начале следующего тика, при ручном
+     * управлении временем - сразу после поступления.
+     */
+    class Simulation {
+    public:
+        using Strand = net::strand<net::io_context::executor_type>;
+        // вызывается в потоке симуляции после публикации снимка, обычно отправляет ответ клиенту
+        using Deferred = std::function<void()>;
+        // выполняется в потоке симуляции, может вернуть отложенное действие
+        using Command = std::function<Deferred()>;
+
+        explicit Simulation(Application& apl);
+        ~Simulation();
+
+        Simulation(const Simulation&) = delete;
+        Simulation& operator=(const Simulation&) = delete;
+
+        // strand потока симуляции, в нем работает планировщик тиков
+        Strand GetStrand() const;
+
+        void Start();
+        // останавливает поток, после возврата с миром можно работать из вызывающего потока
+        void Stop();
+
+        void Submit(Command command);
+
+        // шаг по таймеру: команды, обновление мира, публикация снимка
+        void Tick(std::chrono::milliseconds step, size_t phase, size_t phases);
+
+        // снимок сессии игрока; пока объект жив, снимок не будет удален
+        class SessionView {
+        public:
+            const SessionSnapshot* operator->() const {
+                return session_;
+            }
+            const SessionSnapshot& operator*() const {
+                return *session_;
+            }
+            explicit operator bool() const {
+                return session_ != nullptr;
+            }
+
+        private:
+            friend class Simulation;
+            SessionView(util::EpochDomain::Guard guard, const SessionSnapshot* session)
+                : guard_(std::move(guard))
+                , session_(session) {
+            }
+
+            util::EpochDomain::Guard guard_;
+            const SessionSnapshot* session_;
+        };
+
+        // можно вызывать из любого потока, не ждет потока симуляции
+        SessionView ReadSession(const std::string& token) const;
+        // есть ли в опубликованном снимке игроки с этими токенами; справочник читается один раз на весь пакет
+        std::vector<bool> HasTokens(const std::vector<std::string>& tokens) const;
+
+        // получает снимок в потоке симуляции; пустой снимок - игрока с таким токеном уже нет.
+        // Вызывается внутри тика, поэтому только передает снимок в другой executor, ответ там и собирается
+        using SessionWaiter = std::function<void(SessionView session)>;
+        // long-poll: waiter будет вызван после публикации снимка сессии игрока с версией больше after,
+        // то есть после изменения ее состояния, или по истечении timeout с последним снимком;
+        // ожидание не занимает поток
+        void WaitNextSnapshot(const std::string& token, std::uint64_t after, std::chrono::milliseconds timeout,
+            SessionWaiter waiter);
+
+    private:
+        void ApplyCommands(std::vector<Deferred>& deferred);
+        void RunCommands();
+        void Publish(std::vector<Deferred>& deferred);
+        // отдает ожидающим новый снимок сессии после его публикации с изменениями
+        void WakeWaiters(const SessionCell* cell, std::uint64_t version, std::vector<Deferred>& deferred);
+        void OnWaitTimeout(const SessionCell* cell, const net::steady_timer* timer);
+
+        Application& apl_;
+        const bool apply_on_submit_;
+        net::io_context ioc_;
+        Strand strand_;
+        net::executor_work_guard<net::io_context::executor_type> work_;
+        std::thread thread_;
+
+        util::MpscQueue<Command> commands_;
+        std::atomic<bool> wake_pending_{ false };
+        std::vector<Deferred> deferred_;
+
+        struct PublishedSession {
+            std::unique_ptr<SessionCell> cell;
+            std::uint64_t version = 0;
+            SessionChangeTracker changes;
+        };
+
+        // снимки публикуются по схеме RCU: новая версия заменяет старую атомарно,
+        // старая удаляется, когда ее не читает ни один поток
+        mutable util::EpochDomain epochs_;
+        std::unordered_map<const model::GameSession*, PublishedSession> sessions_;
+        util::RcuCell<TokenDirectory> directory_{ epochs_ };
+        std::uint64_t directory_version_ = 0;
+        bool directory_published_ = false;
+
+        struct ParkedWaiter {
+            std::uint64_t after;
+            SessionWaiter waiter;
+            std::shared_ptr<net::steady_timer> timer;
+        };
+
+        // ожидающие запросы по ячейкам сессий, меняются только в потоке симуляции
+        std::unordered_map<const SessionCell*, std::vector<ParkedWaiter>> parked_;
+    };
+}
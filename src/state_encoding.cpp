@@ -0,0 +1,394 @@
+#include <string_view>
+#include "json_writer.h"
+#include "msgpack.h"
+#include "state_encoding.h"
+
+namespace encoding {
+
+    namespace json = boost::json;
+
+    namespace {
+
+        std::string_view DirectionName(model::Direction dir) {
+            switch (dir) {
+            case model::Direction::North:
+                return "U";
+            case model::Direction::South:
+                return "D";
+            case model::Direction::West:
+                return "L";
+            case model::Direction::East:
+                return "R";
+            }
+            return "";
+        }
+
+        // тик since включается: изменения, пришедшие после ответа на том же тике, не теряются
+        bool ChangedSince(std::uint64_t tick, std::optional<std::uint64_t> since) {
+            return !since || tick >= *since;
+        }
+
+        size_t CountRemoved(const app::SessionSnapshot& session, std::uint64_t since, app::RemovedEntity::Kind kind) {
+            size_t count = 0;
+            for (const auto& removed : *session.removed) {
+                count += removed.tick >= since && removed.kind == kind;
+            }
+            return count;
+        }
+
+        void WritePlayerJson(wire::JsonWriter& writer, const app::PlayerSnapshot& player) {
+            writer.NumberKey(player.id);
+            writer.BeginObject();
+            writer.Key("pos");
+            writer.BeginArray();
+            writer.Double(player.position.x_pos);
+            writer.Double(player.position.y_pos);
+            writer.EndArray();
+            writer.Key("speed");
+            writer.BeginArray();
+            writer.Double(player.speed.h_speed);
+            writer.Double(player.speed.v_speed);
+            writer.EndArray();
+            writer.Key("dir");
+            writer.String(DirectionName(player.direction));
+            // предмет в рюкзаке исторически отдается как [{"id":..},{"type":..}]
+            writer.Key("bag");
+            writer.BeginArray();
+            for (const auto& item : player.bag) {
+                writer.BeginArray();
+                writer.BeginObject();
+                writer.Key("id");
+                writer.Uint(item.GetId());
+                writer.EndObject();
+                writer.BeginObject();
+                writer.Key("type");
+                writer.Int(item.GetType());
+                writer.EndObject();
+                writer.EndArray();
+            }
+            writer.EndArray();
+            writer.Key("score");
+            writer.Uint(player.score);
+            writer.EndObject();
+        }
+
+        void WriteLootJson(wire::JsonWriter& writer, const app::LootSnapshot& loot) {
+            writer.NumberKey(loot.id);
+            writer.BeginObject();
+            writer.Key("type");
+            writer.Int(loot.trophy.GetType());
+            writer.Key("pos");
+            writer.BeginArray();
+            writer.Double(loot.trophy.GetPosition().x_pos);
+            writer.Double(loot.trophy.GetPosition().y_pos);
+            writer.EndArray();
+            writer.EndObject();
+        }
+
+        void WriteRemovedJson(wire::JsonWriter& writer, const app::SessionSnapshot& session,
+            std::uint64_t since, app::RemovedEntity::Kind kind) {
+            writer.BeginArray();
+            for (const auto& removed : *session.removed) {
+                if (removed.tick >= since && removed.kind == kind) {
+                    writer.Uint(removed.id);
+                }
+            }
+            writer.EndArray();
+        }
+
+        // общая структура ответа карты для JSON и MessagePack
+        template <typename Writer>
+        void WriteMap(Writer& writer, const model::Map& map, const json::array& loot_types) {
+            writer.BeginObject(6);
+            writer.Key("id");
+            writer.String(*map.GetId());
+            writer.Key("name");
+            writer.String(map.GetName());
+
+            writer.Key("roads");
+            writer.BeginArray(map.GetRoads().size());
+            for (const auto& road : map.GetRoads()) {
+                writer.BeginObject(3);
+                writer.Key("x0");
+                writer.Int(road.GetStart().x);
+                writer.Key("y0");
+                writer.Int(road.GetStart().y);
+                if (road.IsHorizontal()) {
+                    writer.Key("x1");
+                    writer.Int(road.GetEnd().x);
+                }
+                else {
+                    writer.Key("y1");
+                    writer.Int(road.GetEnd().y);
+                }
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.Key("buildings");
+            writer.BeginArray(map.GetBuildings().size());
+            for (const auto& build : map.GetBuildings()) {
+                writer.BeginObject(4);
+                writer.Key("x");
+                writer.Int(build.GetBounds().position.x);
+                writer.Key("y");
+                writer.Int(build.GetBounds().position.y);
+                writer.Key("w");
+                writer.Int(build.GetBounds().size.width);
+                writer.Key("h");
+                writer.Int(build.GetBounds().size.height);
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.Key("offices");
+            writer.BeginArray(map.GetOffices().size());
+            for (const auto& office : map.GetOffices()) {
+                writer.BeginObject(5);
+                writer.Key("id");
+                writer.String(*office.GetId());
+                writer.Key("x");
+                writer.Int(office.GetPosition().x);
+                writer.Key("y");
+                writer.Int(office.GetPosition().y);
+                writer.Key("offsetX");
+                writer.Int(office.GetOffset().dx);
+                writer.Key("offsetY");
+                writer.Int(office.GetOffset().dy);
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.Key("lootTypes");
+            writer.Json(loot_types);
+            writer.EndObject();
+        }
+
+        template <typename Writer>
+        void WriteMaps(Writer& writer, const std::vector<model::Map>& maps) {
+            writer.BeginArray(maps.size());
+            for (const auto& map : maps) {
+                writer.BeginObject(2);
+                writer.Key("id");
+                writer.String(*map.GetId());
+                writer.Key("name");
+                writer.String(map.GetName());
+                writer.EndObject();
+            }
+            writer.EndArray();
+        }
+
+        void WriteRemoved(wire::MsgPackWriter& writer, const app::SessionSnapshot& session,
+            std::optional<std::uint64_t> since, app::RemovedEntity::Kind kind) {
+            if (!since) {
+                writer.ArrayHeader(0);
+                return;
+            }
+            writer.ArrayHeader(CountRemoved(session, *since, kind));
+            for (const auto& removed : *session.removed) {
+                if (removed.tick >= *since && removed.kind == kind) {
+                    writer.Uint(removed.id);
+                }
+            }
+        }
+    }
+
+    std::string EncodeStateJson(const app::SessionSnapshot& session, std::optional<std::uint64_t> since) {
+        std::string body;
+        // около 150 байт на игрока и 50 на предмет
+        body.reserve(64 + session.players.size() * 160 + session.loot.size() * 56);
+        wire::JsonWriter writer(body);
+
+        writer.BeginObject();
+        writer.Key("players");
+        writer.BeginObject();
+        for (const auto& player : session.players) {
+            if (ChangedSince(player.changed_tick, since)) {
+                WritePlayerJson(writer, player);
+            }
+        }
+        writer.EndObject();
+
+        writer.Key("lostObjects");
+        writer.BeginObject();
+        for (const auto& loot : session.loot) {
+            if (ChangedSince(loot.spawned_tick, since)) {
+                WriteLootJson(writer, loot);
+            }
+        }
+        writer.EndObject();
+
+        if (since) {
+            writer.Key("removedPlayers");
+            WriteRemovedJson(writer, session, *since, app::RemovedEntity::Kind::Player);
+            writer.Key("removedObjects");
+            WriteRemovedJson(writer, session, *since, app::RemovedEntity::Kind::Loot);
+        }
+        writer.EndObject();
+
+        return body;
+    }
+
+    std::string EncodeStateMsgPack(const app::SessionSnapshot& session, std::optional<std::uint64_t> since) {
+        size_t players_count = 0;
+        size_t loot_count = 0;
+        for (const auto& player : session.players) {
+            players_count += ChangedSince(player.changed_tick, since);
+        }
+        for (const auto& loot : session.loot) {
+            loot_count += ChangedSince(loot.spawned_tick, since);
+        }
+
+        // около 60 байт на игрока с пустым рюкзаком и 30 на предмет
+        std::string body;
+        body.reserve(16 + players_count * 64 + loot_count * 32);
+        wire::MsgPackWriter writer(body);
+
+        writer.ArrayHeader(6);
+        writer.Uint(MSGPACK_SCHEMA_VERSION);
+        writer.Uint(session.tick);
+
+        writer.ArrayHeader(players_count);
+        for (const auto& player : session.players) {
+            if (!ChangedSince(player.changed_tick, since)) {
+                continue;
+            }
+            writer.ArrayHeader(8);
+            writer.Uint(player.id);
+            writer.Double(player.position.x_pos);
+            writer.Double(player.position.y_pos);
+            writer.Double(player.speed.h_speed);
+            writer.Double(player.speed.v_speed);
+            writer.String(DirectionName(player.direction));
+            writer.ArrayHeader(player.bag.size());
+            for (const auto& item : player.bag) {
+                writer.ArrayHeader(2);
+                writer.Uint(item.GetId());
+                writer.Int(item.GetType());
+            }
+            writer.Uint(player.score);
+        }
+
+        writer.ArrayHeader(loot_count);
+        for (const auto& loot : session.loot) {
+            if (!ChangedSince(loot.spawned_tick, since)) {
+                continue;
+            }
+            writer.ArrayHeader(4);
+            writer.Uint(loot.id);
+            writer.Int(loot.trophy.GetType());
+            writer.Double(loot.trophy.GetPosition().x_pos);
+            writer.Double(loot.trophy.GetPosition().y_pos);
+        }
+
+        WriteRemoved(writer, session, since, app::RemovedEntity::Kind::Player);
+        WriteRemoved(writer, session, since, app::RemovedEntity::Kind::Loot);
+
+        return body;
+    }
+
+    std::string EncodePlayersJson(const app::SessionSnapshot& session) {
+        std::string body;
+        body.reserve(2 + session.players.size() * 40);
+        wire::JsonWriter writer(body);
+
+        writer.BeginObject();
+        for (const auto& player : session.players) {
+            writer.NumberKey(player.id);
+            writer.BeginObject();
+            writer.Key("name");
+            writer.String(player.name);
+            writer.EndObject();
+        }
+        writer.EndObject();
+
+        return body;
+    }
+
+    std::string EncodePlayersMsgPack(const app::SessionSnapshot& session) {
+        std::string body;
+        wire::MsgPackWriter writer(body);
+
+        writer.ArrayHeader(2);
+        writer.Uint(MSGPACK_SCHEMA_VERSION);
+        writer.ArrayHeader(session.players.size());
+        for (const auto& player : session.players) {
+            writer.ArrayHeader(2);
+            writer.Uint(player.id);
+            writer.String(player.name);
+        }
+
+        return body;
+    }
+
+    std::string EncodeMapJson(const model::Map& map, const json::array& loot_types) {
+        std::string body;
+        wire::JsonWriter writer(body);
+        WriteMap(writer, map, loot_types);
+        return body;
+    }
+
+    std::string EncodeMapMsgPack(const model::Map& map, const json::array& loot_types) {
+        std::string body;
+        wire::MsgPackWriter writer(body);
+        writer.ArrayHeader(2);
+        writer.Uint(MSGPACK_SCHEMA_VERSION);
+        WriteMap(writer, map, loot_types);
+        return body;
+    }
+
+    std::string EncodeMapsJson(const std::vector<model::Map>& maps) {
+        std::string body;
+        wire::JsonWriter writer(body);
+        WriteMaps(writer, maps);
+        return body;
+    }
+
+    std::string EncodeMapsMsgPack(const std::vector<model::Map>& maps) {
+        std::string body;
+        wire::MsgPackWriter writer(body);
+        writer.ArrayHeader(2);
+        writer.Uint(MSGPACK_SCHEMA_VERSION);
+        WriteMaps(writer, maps);
+        return body;
+    }
+
+    std::string EncodeRecordsJson(const std::vector<db::GameRecords>& records) {
+        std::string body;
+        body.reserve(2 + records.size() * 64);
+        wire::JsonWriter writer(body);
+
+        writer.BeginArray();
+        for (const auto& record : records) {
+            writer.BeginObject();
+            writer.Key("name");
+            writer.String(record.name);
+            writer.Key("score");
+            writer.Uint(record.score);
+            writer.Key("playTime");
+            writer.Double(record.played_time);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        return body;
+    }
+
+    std::string EncodeRecordRankJson(size_t place, const db::GameRecords& record) {
+        std::string body;
+        wire::JsonWriter writer(body);
+
+        writer.BeginObject();
+        writer.Key("rank");
+        writer.Uint(place);
+        writer.Key("name");
+        writer.String(record.name);
+        writer.Key("score");
+        writer.Uint(record.score);
+        writer.Key("playTime");
+        writer.Double(record.played_time);
+        writer.EndObject();
+
+        return body;
+    }
+}
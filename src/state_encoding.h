@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <boost/json.hpp>
+#include "database_addition_struct.h"
+#include "world_snapshot.h"
+
+namespace encoding {
+
+    // версия двоичной схемы, первый элемент каждого ответа в MessagePack
+    constexpr std::uint64_t MSGPACK_SCHEMA_VERSION = 1;
+
+    /*
+     * Тело ответа /game/state из снимка сессии. Без since - полное состояние,
+     * с since - игроки и предметы, изменившиеся начиная с этого тика, и списки удаленных.
+     * MessagePack без повторяющихся ключей:
+     * [версия, тик, [игрок...], [предмет...], [id ушедшего игрока...], [id подобранного предмета...]],
+     * игрок - [id, x, y, vx, vy, dir, [[id, type]...], score], предмет - [id, type, x, y].
+     */
+    std::string EncodeStateJson(const app::SessionSnapshot& session, std::optional<std::uint64_t> since = std::nullopt);
+    std::string EncodeStateMsgPack(const app::SessionSnapshot& session, std::optional<std::uint64_t> since = std::nullopt);
+
+    // тело ответа /game/players; MessagePack: [версия, [[id, name]...]]
+    std::string EncodePlayersJson(const app::SessionSnapshot& session);
+    std::string EncodePlayersMsgPack(const app::SessionSnapshot& session);
+
+    // карта целиком и список карт; MessagePack: [версия, объект как в JSON]
+    std::string EncodeMapJson(const model::Map& map, const boost::json::array& loot_types);
+    std::string EncodeMapMsgPack(const model::Map& map, const boost::json::array& loot_types);
+    std::string EncodeMapsJson(const std::vector<model::Map>& maps);
+    std::string EncodeMapsMsgPack(const std::vector<model::Map>& maps);
+
+    std::string EncodeRecordsJson(const std::vector<db::GameRecords>& records);
+    // {"rank": место с 1, "name": .., "score": .., "playTime": ..}
+    std::string EncodeRecordRankJson(size_t place, const db::GameRecords& record);
+}
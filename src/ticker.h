@@ -1,70 +0,0 @@
-#pragma once
-#include <boost/asio.hpp>
-#include <boost/beast.hpp>
-#include <cassert>
-#include <chrono>
-#include <functional>
-#include <memory>
-
-namespace timer {
-
-    namespace net = boost::asio;
-    namespace sys = boost::system;
-
-    class Ticker : public std::enable_shared_from_this<Ticker> {
-    public:
-
-        using Strand = net::strand<net::io_context::executor_type>;
-        using Handler = std::function<void(std::chrono::milliseconds delta)>;
-
-        // handler    strand   period
-        Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
-            : strand_{ strand }
-            , period_{ period }
-            , handler_{ std::move(handler) } {
-        }
-
-        void Start() {
-            net::dispatch(strand_, [self = shared_from_this()]{
-                self->last_tick_ = Clock::now();
-                self->ScheduleTick();
-                });
-        }
-
-    private:
-        void ScheduleTick() {
-            assert(strand_.running_in_this_thread());
-            timer_.expires_after(period_);
-            timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
-                self->OnTick(ec);
-            });
-        }
-
-        void OnTick(sys::error_code ec) {
-            using namespace std::chrono;
-            assert(strand_.running_in_this_thread());
-
-            if (!ec) {
-                auto this_tick = Clock::now();
-                auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
-                last_tick_ = this_tick;
-                try {
-                    handler_(delta);
-                }
-                catch (std::exception) {
-                }
-                ScheduleTick();
-            }
-        }
-
-    private:
-
-        using Clock = std::chrono::steady_clock;
-
-        Strand strand_;
-        std::chrono::milliseconds period_;
-        net::steady_timer timer_{ strand_ };
-        Handler handler_;
-        std::chrono::steady_clock::time_point last_tick_;
-    };
-}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace util {
+
+/*
+ * Хешированное колесо таймеров.
+ * Запись попадает в слот deadline / granularity по модулю числа слотов. При продвижении
+ * времени просматриваются только слоты, через которые прошли стрелки, поэтому
+ * стоимость тика пропорциональна числу сработавших таймеров, а не числу всех записей.
+ * Отмены нет: устаревшие записи вызывающая сторона распознает сама (например, по поколению).
+ */
+template <typename Value>
+class TimerWheel {
+public:
+    TimerWheel(std::uint64_t granularity, size_t slots_count)
+        : granularity_(std::max<std::uint64_t>(granularity, 1))
+        , slots_(std::max<size_t>(slots_count, 1)) {
+    }
+
+    void Schedule(std::uint64_t deadline, Value value) {
+        // просроченные таймеры кладем в ближайший слот, они сработают на следующем шаге
+        const std::uint64_t tick = std::max(deadline, now_) / granularity_;
+        slots_[tick % slots_.size()].push_back({ deadline, next_seq_++, std::move(value) });
+        ++size_;
+    }
+
+    // продвигает время до now и вызывает on_expired для сработавших таймеров
+    // в порядке возрастания срока, при равных сроках - в порядке постановки
+    template <typename Fn>
+    void Advance(std::uint64_t now, Fn&& on_expired) {
+        if (now < now_) {
+            return;
+        }
+
+        const std::uint64_t from_tick = now_ / granularity_;
+        const std::uint64_t to_tick = now / granularity_;
+        const std::uint64_t ticks = std::min<std::uint64_t>(to_tick - from_tick + 1, slots_.size());
+        now_ = now;
+
+        expired_.clear();
+        for (std::uint64_t t = 0; t < ticks; ++t) {
+            auto& slot = slots_[(from_tick + t) % slots_.size()];
+            auto keep = std::partition(slot.begin(), slot.end(), [now](const Entry& entry) {
+                return entry.deadline > now;
+            });
+            std::move(keep, slot.end(), std::back_inserter(expired_));
+            slot.erase(keep, slot.end());
+        }
+
+        size_ -= expired_.size();
+        std::sort(expired_.begin(), expired_.end(), [](const Entry& l, const Entry& r) {
+            return l.deadline != r.deadline ? l.deadline < r.deadline : l.seq < r.seq;
+        });
+        for (auto& entry : expired_) {
+            on_expired(entry.value);
+        }
+        expired_.clear();
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    std::uint64_t Now() const {
+        return now_;
+    }
+
+private:
+    struct Entry {
+        std::uint64_t deadline;
+        std::uint64_t seq;
+        Value value;
+    };
+
+    std::uint64_t granularity_;
+    std::vector<std::vector<Entry>> slots_;
+    std::vector<Entry> expired_;
+    std::uint64_t now_ = 0;
+    std::uint64_t next_seq_ = 0;
+    size_t size_ = 0;
+};
+
+}  // util
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <utility>
+#include "work_stealing_pool.h"
+
+namespace util {
+
+WorkStealingPool::WorkStealingPool(size_t workers_count) {
+    workers_count = std::max<size_t>(workers_count, 1);
+    queues_.reserve(workers_count);
+    for (size_t i = 0; i < workers_count; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    threads_.reserve(workers_count - 1);
+    for (size_t i = 1; i < workers_count; ++i) {
+        threads_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t WorkStealingPool::WorkersCount() const {
+    return queues_.size();
+}
+
+void WorkStealingPool::Run(size_t count, const Task& task) {
+    if (count == 0) {
+        return;
+    }
+
+    // соседние задачи достаются одному воркеру, воровство выравнивает неравные блоки
+    const size_t workers = queues_.size();
+    for (size_t w = 0; w < workers; ++w) {
+        const size_t begin = count * w / workers;
+        const size_t end = count * (w + 1) / workers;
+        std::lock_guard lock(queues_[w]->mutex);
+        for (size_t i = begin; i < end; ++i) {
+            queues_[w]->tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &task;
+        busy_ = threads_.size();
+        error_ = nullptr;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    Drain(0);
+
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void WorkStealingPool::WorkerLoop(size_t worker) {
+    size_t seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex_);
+            start_cv_.wait(lock, [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+            if (stop_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        Drain(worker);
+
+        std::lock_guard lock(mutex_);
+        if (--busy_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::Drain(size_t worker) {
+    size_t index;
+    while (TakeTask(worker, index)) {
+        try {
+            (*task_)(worker, index);
+        }
+        catch (...) {
+            std::lock_guard lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::TakeTask(size_t worker, size_t& index) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            index = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    const size_t workers = queues_.size();
+    for (size_t k = 1; k < workers; ++k) {
+        Queue& victim = *queues_[(worker + k) % workers];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // util
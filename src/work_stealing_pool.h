@@ -0,0 +1,58 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+/*
+ * Пул потоков с перехватом работы для задач вида fork-join.
+ * Run раздает индексы задач непрерывными блоками по очередям воркеров, каждый воркер
+ * берет задачи из начала своей очереди, а опустевший ворует с конца чужих.
+ * Вызывающий поток работает как воркер с номером 0, Run возвращается, когда выполнены все задачи.
+ */
+class WorkStealingPool {
+public:
+    // task(worker, index): worker - номер воркера в диапазоне [0, WorkersCount())
+    using Task = std::function<void(size_t, size_t)>;
+
+    explicit WorkStealingPool(size_t workers_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t WorkersCount() const;
+
+    // выполняет task для всех index из [0, count), первое исключение из задач пробрасывается наружу
+    void Run(size_t count, const Task& task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void WorkerLoop(size_t worker);
+    void Drain(size_t worker);
+    bool TakeTask(size_t worker, size_t& index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    const Task* task_ = nullptr;
+    size_t generation_ = 0;
+    size_t busy_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+}  // util
@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "model.h"
+#include "rcu.h"
+
+namespace app {
+
+    // неизменяемые копии состояния мира для обработчиков чтения
+    struct PlayerSnapshot {
+        int id;
+        std::string name;
+        model::Position position;
+        model::Speed speed;
+        model::Direction direction;
+        std::vector<model::Trophy> bag;
+        size_t score;
+        // ревизия собаки в модели и тик, на котором она последний раз менялась
+        std::uint64_t revision = 0;
+        std::uint64_t changed_tick = 0;
+    };
+
+    struct LootSnapshot {
+        size_t id;
+        model::Trophy trophy;
+        std::uint64_t spawned_tick = 0;
+    };
+
+    // игрок ушел из сессии или предмет подобран
+    struct RemovedEntity {
+        enum class Kind { Player, Loot };
+
+        std::uint64_t tick;
+        Kind kind;
+        size_t id;
+    };
+
+    struct SessionSnapshot {
+        // номер публикации снимка этой сессии
+        std::uint64_t version = 0;
+        // номер тика, после которого снят снимок
+        std::uint64_t tick = 0;
+        // игроки по возрастанию id
+        std::vector<PlayerSnapshot> players;
+        std::vector<LootSnapshot> loot;
+        // удаления за последние тики; разница считается для since не меньше history_from
+        std::shared_ptr<const std::vector<RemovedEntity>> removed;
+        std::uint64_t history_from = 0;
+
+        bool CanDiffSince(std::uint64_t since) const {
+            return since >= history_from && since <= tick;
+        }
+
+        // число форматов тела ответа, для каждого свой кэш
+        static constexpr size_t STATE_BODY_FORMATS = 2;
+
+        // тело ответа /game/state собирает первый запрос после публикации, остальные игроки
+        // сессии получают ту же строку; снимок публикуется заново только при изменении сессии
+        // и приходит с пустым кэшем
+        template <typename Fn>
+        std::shared_ptr<const std::string> GetStateBody(size_t format, Fn&& build) const {
+            StateBody& body = state_bodies_.at(format);
+            std::call_once(body.once, [&] {
+                body.data = std::make_shared<const std::string>(build(*this));
+            });
+            return body.data;
+        }
+
+        // то же для /game/players: одновременные запросы игроков сессии ждут одного кодирования
+        template <typename Fn>
+        std::shared_ptr<const std::string> GetPlayersBody(size_t format, Fn&& build) const {
+            StateBody& body = players_bodies_.at(format);
+            std::call_once(body.once, [&] {
+                body.data = std::make_shared<const std::string>(build(*this));
+            });
+            return body.data;
+        }
+
+        // тело с изменениями от since; запросы, ждавшие этого снимка, обычно приходят с одним since,
+        // поэтому хранится последнее собранное тело каждого формата
+        template <typename Fn>
+        std::shared_ptr<const std::string> GetDeltaBody(size_t format, std::uint64_t since, Fn&& build) const {
+            DeltaBody& body = delta_bodies_.at(format);
+            {
+                std::lock_guard lock(body.mutex);
+                if (body.data && body.since == since) {
+                    return body.data;
+                }
+            }
+            auto data = std::make_shared<const std::string>(build(*this, since));
+            std::lock_guard lock(body.mutex);
+            body.since = since;
+            body.data = data;
+            return data;
+        }
+
+    private:
+        struct StateBody {
+            std::once_flag once;
+            std::shared_ptr<const std::string> data;
+        };
+
+        struct DeltaBody {
+            std::mutex mutex;
+            std::uint64_t since = 0;
+            std::shared_ptr<const std::string> data;
+        };
+
+        mutable std::array<StateBody, STATE_BODY_FORMATS> state_bodies_;
+        mutable std::array<StateBody, STATE_BODY_FORMATS> players_bodies_;
+        mutable std::array<DeltaBody, STATE_BODY_FORMATS> delta_bodies_;
+    };
+
+    using SessionCell = util::RcuCell<SessionSnapshot>;
+
+    // соответствие токена игрока ячейке его сессии, меняется только при входе и уходе игроков
+    struct TokenDirectory {
+        std::unordered_map<std::string, const SessionCell*> sessions;
+
+        const SessionCell* Find(const std::string& token) const {
+            auto it = sessions.find(token);
+            return it == sessions.end() ? nullptr : it->second;
+        }
+    };
+}
@@ -2,7 +2,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_templated.hpp>
 #include "../src/collision_detector.h"
+#include "../src/work_stealing_pool.h"
 
+#include <random>
 #include <sstream>
 
 static const double EPSILON = 1e-10;
@@ -181,4 +183,160 @@ SCENARIO("Check collision method \"FindGatherEvents\"") {
             CHECK(result_gather_no_move.empty());
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Broadphase \"FindGatherEvents\" matches brute force") {
+    using namespace std::literals;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(-50.0, 50.0);
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    std::uniform_int_distribution<int> axis(0, 2);
+
+    for (int round = 0; round < 20; ++round) {
+        std::vector<collision_detector::Item> items;
+        for (size_t i = 0; i < 500; ++i) {
+            items.push_back({ i, {coord(gen), coord(gen)}, collision_detector::ITEM_COLLIDER_SIZE });
+        }
+
+        std::vector<collision_detector::Office> offices;
+        for (int i = 0; i < 20; ++i) {
+            offices.push_back({ "o"s + std::to_string(i), {std::round(coord(gen)), std::round(coord(gen))},
+                collision_detector::OFFICE_COLLIDER_SIZE });
+        }
+
+        std::vector<collision_detector::Gatherer> gaths;
+        for (int i = 0; i < 100; ++i) {
+            geom::Point2D start{ coord(gen), coord(gen) };
+            geom::Point2D end = start;
+            // собаки двигаются вдоль осей, но проверим и произвольные отрезки
+            switch (axis(gen)) {
+            case 0:
+                end.x += step(gen);
+                break;
+            case 1:
+                end.y += step(gen);
+                break;
+            default:
+                end.x += step(gen);
+                end.y += step(gen);
+            }
+            gaths.push_back({ Token(std::to_string(i)), start, end, collision_detector::DOG_COLLIDER_SIZE });
+        }
+
+        TestItemGathererProvider provider{ items, gaths, offices };
+        auto expected = collision_detector::FindGatherEventsBruteForce(provider);
+        auto result = collision_detector::FindGatherEvents(provider);
+
+        REQUIRE(result.size() == expected.size());
+        CHECK_THAT(result, compare::IsEqualResult(expected, compare::CompareResults()));
+    }
+}
+
+SCENARIO("Batch \"TryCollectPoints\" matches scalar \"TryCollectPoint\"") {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(-20.0, 20.0);
+
+    collision_detector::PackedItems items;
+    // нечетное количество, чтобы проверить и хвост после векторной части
+    for (size_t i = 0; i < 1003; ++i) {
+        items.Add(i, { coord(gen), coord(gen) }, (i % 3 == 0) ? 0.1 : collision_detector::ITEM_COLLIDER_SIZE);
+    }
+
+    collision_detector::BatchCollectionResult batch;
+    for (int round = 0; round < 50; ++round) {
+        geom::Point2D a{ coord(gen), coord(gen) };
+        geom::Point2D b{ coord(gen), coord(gen) };
+        collision_detector::TryCollectPoints(a, b, collision_detector::DOG_COLLIDER_SIZE, items, batch);
+
+        REQUIRE(batch.hit_mask.size() == items.Size());
+        for (size_t i = 0; i < items.Size(); ++i) {
+            auto scalar = collision_detector::TryCollectPoint(a, b, { items.x[i], items.y[i] });
+            CHECK(batch.sq_distance[i] == scalar.sq_distance);
+            CHECK(batch.proj_ratio[i] == scalar.proj_ratio);
+            CHECK((batch.hit_mask[i] == 1) == scalar.IsCollected(collision_detector::DOG_COLLIDER_SIZE + items.width[i]));
+        }
+    }
+
+    WHEN("segment is degenerate") {
+        collision_detector::TryCollectPoints({ 1, 1 }, { 1, 1 }, collision_detector::DOG_COLLIDER_SIZE, items, batch);
+        THEN("nothing is collected") {
+            CHECK(std::none_of(batch.hit_mask.begin(), batch.hit_mask.end(), [](auto hit) { return hit != 0; }));
+        }
+    }
+}
+
+SCENARIO("Prebuilt office colliders give the same events") {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> coord(-30.0, 30.0);
+    std::uniform_real_distribution<double> step(-5.0, 5.0);
+
+    std::vector<collision_detector::Item> items;
+    for (size_t i = 0; i < 200; ++i) {
+        items.push_back({ i, {coord(gen), coord(gen)}, collision_detector::ITEM_COLLIDER_SIZE });
+    }
+    std::vector<collision_detector::Item> offices;
+    for (size_t i = 0; i < 50; ++i) {
+        offices.push_back({ i, {std::round(coord(gen)), std::round(coord(gen))}, collision_detector::OFFICE_COLLIDER_SIZE });
+    }
+    std::vector<collision_detector::IndexedGatherer> gaths;
+    for (int i = 0; i < 200; ++i) {
+        geom::Point2D start{ std::round(coord(gen)), coord(gen) };
+        gaths.push_back({ start, {start.x, start.y + step(gen)}, collision_detector::DOG_COLLIDER_SIZE });
+    }
+
+    collision_detector::StaticColliders static_offices(offices, collision_detector::DOG_COLLIDER_SIZE);
+
+    auto expected = collision_detector::FindGatherEvents(collision_detector::SpanProvider{ items, gaths, offices });
+    auto result = collision_detector::FindGatherEvents(collision_detector::SpanProvider{ items, gaths, static_offices });
+
+    REQUIRE(result.size() == expected.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        CHECK(result[i].is_office == expected[i].is_office);
+        CHECK(result[i].item_id == expected[i].item_id);
+        CHECK(result[i].gatherer_idx == expected[i].gatherer_idx);
+        CHECK(result[i].time == expected[i].time);
+    }
+}
+
+SCENARIO("Parallel \"FindGatherEvents\" gives the same events") {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> coord(-100, 100);
+    std::uniform_int_distribution<int> step(-4, 4);
+
+    // целые координаты дают много событий с одинаковым временем
+    std::vector<collision_detector::Item> items;
+    for (size_t i = 0; i < 3000; ++i) {
+        items.push_back({ i, {double(coord(gen)), double(coord(gen))}, collision_detector::ITEM_COLLIDER_SIZE });
+    }
+    std::vector<collision_detector::Item> offices;
+    for (size_t i = 0; i < 100; ++i) {
+        offices.push_back({ i, {double(coord(gen)), double(coord(gen))}, collision_detector::OFFICE_COLLIDER_SIZE });
+    }
+    std::vector<collision_detector::IndexedGatherer> gaths;
+    for (int i = 0; i < 5000; ++i) {
+        geom::Point2D start{ double(coord(gen)), double(coord(gen)) };
+        geom::Point2D end = i % 2 ? geom::Point2D{ start.x + step(gen), start.y } : geom::Point2D{ start.x, start.y + step(gen) };
+        gaths.push_back({ start, end, collision_detector::DOG_COLLIDER_SIZE });
+    }
+
+    collision_detector::StaticColliders static_offices(offices, collision_detector::DOG_COLLIDER_SIZE);
+    collision_detector::SpanProvider provider{ items, gaths, static_offices };
+
+    auto expected = collision_detector::FindGatherEvents(provider);
+
+    util::WorkStealingPool pool(4);
+    collision_detector::ParallelGatherBuffers buffers;
+    std::vector<collision_detector::IndexedGatheringEvent> result;
+    // второй прогон проверяет переиспользование буферов
+    for (int run = 0; run < 2; ++run) {
+        collision_detector::FindGatherEventsParallel(provider, pool, buffers, result);
+
+        REQUIRE(result.size() == expected.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            CHECK(result[i].is_office == expected[i].is_office);
+            CHECK(result[i].item_id == expected[i].item_id);
+            CHECK(result[i].gatherer_idx == expected[i].gatherer_idx);
+            CHECK(result[i].sq_distance == expected[i].sq_distance);
+            CHECK(result[i].time == expected[i].time);
+        }
+    }
+}
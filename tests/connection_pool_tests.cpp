@@ -0,0 +1,29 @@
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "../src/db_connector.h"
+
+using namespace std::chrono_literals;
+
+SCENARIO("Bounded wait for a pooled connection") {
+    // пул только хранит и раздает указатели, живой сервер для проверки ожидания не нужен
+    constexpr size_t capacity = 2;
+    constexpr auto wait_timeout = 100ms;
+    db_conn::ConnectionPool pool(capacity, wait_timeout, [] {
+        return std::shared_ptr<pqxx::connection>();
+    });
+
+    GIVEN("every connection taken") {
+        std::vector<db_conn::ConnectionPool::ConnectionWrapper> taken;
+        for (size_t i = 0; i < capacity; ++i) {
+            taken.push_back(pool.GetConnection());
+        }
+
+        THEN("the next request throws PoolTimeout after the wait") {
+            const auto start = std::chrono::steady_clock::now();
+            CHECK_THROWS_AS(pool.GetConnection(), db_conn::PoolTimeout);
+            CHECK(std::chrono::steady_clock::now() - start >= wait_timeout);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../src/event_simulation.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Map MakeMap() {
+    model::Map map(model::Map::Id("map1"s), "Map 1"s);
+    map.AddRoad({ model::Road::HORIZONTAL, {0, 0}, 10 });
+    map.AddRoad({ model::Road::HORIZONTAL, {10, 0}, 20 });
+    map.AddRoad({ model::Road::VERTICAL, {20, 0}, 10 });
+    map.AddOffice({ model::Office::Id("o1"s), {15, 0}, {0, 0} });
+    map.SetDogSpeedOnMap(1.0);
+    map.SetBagCapacity(3);
+    return map;
+}
+
+collision_detector::StaticColliders MakeOffices(const model::Map& map) {
+    std::vector<collision_detector::Item> offices;
+    for (size_t i = 0; i < map.GetOffices().size(); ++i) {
+        offices.push_back({ i, {static_cast<double>(map.GetOffices()[i].GetPosition().x),
+            static_cast<double>(map.GetOffices()[i].GetPosition().y)}, collision_detector::OFFICE_COLLIDER_SIZE });
+    }
+    return collision_detector::StaticColliders(std::move(offices), collision_detector::DOG_COLLIDER_SIZE);
+}
+
+}  // namespace
+
+SCENARIO("Event simulation stop position") {
+    model::Map map = MakeMap();
+
+    WHEN("dog moves along connected roads") {
+        auto stop = event_sim::EventSimulator::ComputeStopPosition(map, { 1, 0 }, { 1, 0 });
+        THEN("it stops at the border of the last road") {
+            CHECK(stop == model::Position{ 20.4, 0 });
+        }
+    }
+    WHEN("dog moves off the road end") {
+        auto stop = event_sim::EventSimulator::ComputeStopPosition(map, { 1, 0 }, { 0, -1 });
+        THEN("it stops at the road border") {
+            CHECK(stop == model::Position{ 1, -0.4 });
+        }
+    }
+}
+
+SCENARIO("Event simulation collects items and returns them to office") {
+    model::Map map = MakeMap();
+    auto offices = MakeOffices(map);
+
+    GIVEN("a session with one moving dog and two trophies on the road") {
+        model::GameSession session(model::Dog("Rex"s, { 0, 0 }, map.GetBagCapacity()), map);
+        model::Dog* dog = session.GetLastDog();
+        dog->SetSpeed({ 1, 0 });
+        session.AddTrophyOnMap({ 0, 2, { 3, 0.1 } });
+        session.AddTrophyOnMap({ 1, 5, { 8, -0.2 } });
+
+        event_sim::EventSimulator sim;
+
+        WHEN("one long tick passes") {
+            sim.Advance(session, 100'000, offices);
+            THEN("dog picked both trophies, scored at the office and stopped at the border") {
+                CHECK(session.GetCountTrophyOnMap() == 0);
+                CHECK(dog->GetItemFromBag().empty());
+                CHECK(dog->GetScore() == 7);
+                CHECK(dog->GetPosition() == model::Position{ 20.4, 0 });
+            }
+        }
+
+        WHEN("time passes in short ticks") {
+            for (int i = 0; i < 5; ++i) {
+                sim.Advance(session, 1000, offices);
+            }
+            THEN("dog is on its way with the first trophy") {
+                CHECK(dog->GetPosition() == model::Position{ 5, 0 });
+                CHECK(dog->GetItemFromBag().size() == 1);
+                CHECK(session.GetCountTrophyOnMap() == 1);
+            }
+
+            AND_WHEN("dog turns back and a trophy appears behind it") {
+                dog->SetSpeed({ -1, 0 });
+                sim.OnDogMovementChanged(session, dog, offices);
+                model::Trophy trophy{ 2, 1, { 2, 0 } };
+                session.AddTrophyOnMap(trophy);
+                sim.OnTrophyAdded(session, trophy);
+                sim.Advance(session, 10'000, offices);
+
+                THEN("dog picks the new trophy and misses the one behind") {
+                    CHECK(dog->GetItemFromBag().size() == 2);
+                    CHECK(session.GetCountTrophyOnMap() == 1);
+                    CHECK(dog->GetPosition() == model::Position{ -0.4, 0 });
+                }
+            }
+        }
+    }
+}
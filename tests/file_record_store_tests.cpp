@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../src/file_record_store.h"
+
+namespace {
+
+using Row = std::tuple<std::string, std::uint64_t, std::int64_t>;
+
+std::vector<Row> ReadAll(db::FileRecordStore& store) {
+    std::vector<Row> rows;
+    store.ReadAllRecords([&rows](std::string name, std::uint64_t score, std::int64_t play_time_ms) {
+        rows.emplace_back(std::move(name), score, play_time_ms);
+    });
+    return rows;
+}
+
+// временный файл удаляется и до, и после теста
+struct TempFile {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "file_record_store_test.log";
+    TempFile() {
+        std::filesystem::remove(path);
+    }
+    ~TempFile() {
+        std::filesystem::remove(path);
+    }
+};
+
+}  // namespace
+
+SCENARIO("Embedded file record store") {
+    TempFile file;
+
+    GIVEN("a new store") {
+        auto store = std::make_unique<db::FileRecordStore>(file.path);
+
+        THEN("it is empty") {
+            CHECK(store->Size() == 0);
+            CHECK(ReadAll(*store).empty());
+        }
+
+        WHEN("batches are written") {
+            store->WriteRecords({ { "Rex", 10, 5000.4 }, { "", 0, 0 } });
+            store->WriteRecords({ { "Ace", 30, 7000.6 } });
+
+            THEN("records are read back in order with time in whole ms") {
+                auto rows = ReadAll(*store);
+                REQUIRE(rows.size() == 3);
+                CHECK(rows[0] == Row{ "Rex", 10, 5000 });
+                CHECK(rows[1] == Row{ "", 0, 0 });
+                CHECK(rows[2] == Row{ "Ace", 30, 7001 });
+            }
+            AND_WHEN("the store is reopened") {
+                store.reset();
+                db::FileRecordStore reopened(file.path);
+
+                THEN("the records survive") {
+                    CHECK(reopened.Size() == 3);
+                    CHECK(ReadAll(reopened)[2] == Row{ "Ace", 30, 7001 });
+                }
+            }
+        }
+
+        WHEN("more records are written than the initial file holds") {
+            std::vector<db::GameRecords> batch;
+            for (int i = 0; i < 5000; ++i) {
+                batch.push_back({ "dog" + std::to_string(i), static_cast<size_t>(i), 1000.0 * i });
+            }
+            store->WriteRecords(batch);
+            store->WriteRecords(batch);
+            store.reset();
+
+            THEN("the file grows and keeps every record") {
+                db::FileRecordStore reopened(file.path);
+                auto rows = ReadAll(reopened);
+                REQUIRE(rows.size() == 10000);
+                CHECK(rows[4999] == Row{ "dog4999", 4999, 4999000 });
+                CHECK(rows[9999] == Row{ "dog4999", 4999, 4999000 });
+            }
+        }
+    }
+
+    GIVEN("a store whose last record was torn") {
+        {
+            db::FileRecordStore store(file.path);
+            store.WriteRecords({ { "Rex", 10, 5000 }, { "Bob", 20, 6000 } });
+        }
+        // портится имя второй записи: контрольная сумма перестает сходиться
+        {
+            std::fstream out(file.path, std::ios::binary | std::ios::in | std::ios::out);
+            out.seekp(8 + 32 + 24);
+            out.put('X');
+        }
+
+        THEN("the tail is dropped and new records go in its place") {
+            {
+                db::FileRecordStore store(file.path);
+                CHECK(store.Size() == 1);
+                store.WriteRecords({ { "Amy", 5, 100 } });
+            }
+            db::FileRecordStore store(file.path);
+            auto rows = ReadAll(store);
+            REQUIRE(rows.size() == 2);
+            CHECK(rows[0] == Row{ "Rex", 10, 5000 });
+            CHECK(rows[1] == Row{ "Amy", 5, 100 });
+        }
+    }
+
+    GIVEN("a file in another format") {
+        {
+            std::ofstream out(file.path, std::ios::binary);
+            out << "not a records log";
+        }
+        THEN("opening it fails") {
+            CHECK_THROWS_AS(db::FileRecordStore(file.path), std::runtime_error);
+        }
+    }
+}
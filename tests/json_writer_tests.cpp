@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <string>
+#include "../src/json_writer.h"
+
+using namespace std::literals;
+
+SCENARIO("Streaming JSON writer") {
+    GIVEN("an empty buffer") {
+        std::string buffer;
+        wire::JsonWriter writer(buffer);
+
+        WHEN("nested objects and arrays are written") {
+            writer.BeginObject();
+            writer.NumberKey(12);
+            writer.BeginObject();
+            writer.Key("pos");
+            writer.BeginArray();
+            writer.Double(1.5);
+            writer.Double(-0.25);
+            writer.EndArray();
+            writer.Key("bag");
+            writer.BeginArray();
+            writer.EndArray();
+            writer.Key("ok");
+            writer.Bool(true);
+            writer.EndObject();
+            writer.Key("empty");
+            writer.BeginObject();
+            writer.EndObject();
+            writer.Key("list");
+            writer.BeginArray();
+            writer.Int(-7);
+            writer.Uint(std::numeric_limits<std::uint64_t>::max());
+            writer.Null();
+            writer.EndArray();
+            writer.EndObject();
+
+            THEN("commas are placed only between elements") {
+                CHECK(buffer == R"({"12":{"pos":[1.5,-0.25],"bag":[],"ok":true},"empty":{},"list":[-7,18446744073709551615,null]})");
+            }
+        }
+
+        WHEN("doubles are written") {
+            writer.BeginArray();
+            writer.Double(0.1);
+            writer.Double(10.0);
+            writer.Double(1e300);
+            writer.Double(std::numeric_limits<double>::infinity());
+            writer.EndArray();
+
+            THEN("they use the shortest round-trip form and non-finite values become null") {
+                CHECK(buffer == "[0.1,10,1e+300,null]");
+            }
+        }
+
+        WHEN("strings need escaping") {
+            writer.String("a\"b\\c\n\t\x01/\xd0\x9f"sv);
+
+            THEN("only quotes, backslashes and control characters are escaped") {
+                CHECK(buffer == "\"a\\\"b\\\\c\\n\\t\\u0001/\xd0\x9f\""s);
+            }
+        }
+    }
+}
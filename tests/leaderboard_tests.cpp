@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../src/leaderboard.h"
+
+namespace {
+
+struct Row {
+    std::string name;
+    std::uint64_t score;
+    std::int64_t play_time_ms;
+};
+
+// порядок запроса к базе: score DESC, play_time_ms, name
+bool RowBefore(const Row& lhs, const Row& rhs) {
+    return std::tie(rhs.score, lhs.play_time_ms, lhs.name) < std::tie(lhs.score, rhs.play_time_ms, rhs.name);
+}
+
+}  // namespace
+
+SCENARIO("In-memory leaderboard") {
+    GIVEN("an empty leaderboard") {
+        db::Leaderboard board;
+
+        THEN("pages and ranks are empty") {
+            CHECK(board.GetPage(0, 10).empty());
+            CHECK_FALSE(board.FindRank("Rex"));
+        }
+
+        WHEN("records are added") {
+            board.Add("Rex", 10, 5000);
+            board.Add("Ace", 30, 7000);
+            board.Add("Bob", 10, 3000);
+            board.Add("Rex", 20, 1000);
+            board.Add("Amy", 10, 3000);
+
+            THEN("a page follows the database order") {
+                auto page = board.GetPage(0, 10);
+                REQUIRE(page.size() == 5);
+                CHECK(page[0].name == "Ace");
+                CHECK(page[1].name == "Rex");
+                CHECK(page[1].score == 20);
+                CHECK(page[2].name == "Amy");
+                CHECK(page[3].name == "Bob");
+                CHECK(page[4].name == "Rex");
+                CHECK(page[4].played_time == 5.0);
+            }
+            THEN("offset and count cut the page") {
+                auto page = board.GetPage(2, 2);
+                REQUIRE(page.size() == 2);
+                CHECK(page[0].name == "Amy");
+                CHECK(page[1].name == "Bob");
+                CHECK(board.GetPage(5, 3).empty());
+            }
+            THEN("rank by name is the best result of that name") {
+                auto rank = board.FindRank("Rex");
+                REQUIRE(rank);
+                CHECK(rank->place == 2);
+                CHECK(rank->record.score == 20);
+                CHECK(board.FindRank("Bob")->place == 4);
+            }
+            THEN("a cursor page starts right after the cursor record") {
+                auto page = board.GetPageAfter({ 20, 1000, "Rex" }, 2);
+                REQUIRE(page.size() == 2);
+                CHECK(page[0].name == "Amy");
+                CHECK(page[1].name == "Bob");
+                CHECK(board.GetPageAfter({ 10, 5000, "Rex" }, 3).empty());
+            }
+            THEN("a cursor between records continues from the next one") {
+                auto page = board.GetPageAfter({ 10, 3000, "Ann" }, 10);
+                REQUIRE(page.size() == 2);
+                CHECK(page[0].name == "Bob");
+                CHECK(board.GetPageAfter({ 100, 0, "" }, 1)[0].name == "Ace");
+            }
+        }
+    }
+
+    GIVEN("many random records") {
+        db::Leaderboard board;
+        std::vector<Row> rows;
+        std::mt19937 random(7);
+        for (int i = 0; i < 5000; ++i) {
+            Row row{ "dog" + std::to_string(random() % 700), random() % 50, static_cast<std::int64_t>(random() % 100) * 100 };
+            board.Add(row.name, row.score, row.play_time_ms);
+            rows.push_back(row);
+        }
+        std::stable_sort(rows.begin(), rows.end(), RowBefore);
+
+        THEN("every page matches a full sort") {
+            CHECK(board.Size() == rows.size());
+            for (size_t offset = 0; offset < rows.size(); offset += 937) {
+                auto page = board.GetPage(offset, 100);
+                REQUIRE(page.size() == std::min<size_t>(100, rows.size() - offset));
+                for (size_t i = 0; i < page.size(); ++i) {
+                    CHECK(page[i].name == rows[offset + i].name);
+                    CHECK(page[i].score == rows[offset + i].score);
+                }
+            }
+        }
+        THEN("walking with cursors gives the same pages as offsets") {
+            // одинаковые ключи курсор не различает, поэтому сравниваются только различимые записи
+            std::vector<Row> unique_rows;
+            std::unique_copy(rows.begin(), rows.end(), std::back_inserter(unique_rows), [](const Row& lhs, const Row& rhs) {
+                return !RowBefore(lhs, rhs) && !RowBefore(rhs, lhs);
+            });
+            std::vector<db::GameRecords> walked = board.GetPage(0, 100);
+            while (walked.size() < board.Size()) {
+                const db::GameRecords& last = walked.back();
+                auto page = board.GetPageAfter({ last.score, std::llround(last.played_time * 1000), last.name }, 100);
+                if (page.empty()) {
+                    break;
+                }
+                walked.insert(walked.end(), page.begin(), page.end());
+            }
+            auto last_unique = std::unique(walked.begin(), walked.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.name == rhs.name && lhs.score == rhs.score && lhs.played_time == rhs.played_time;
+            });
+            walked.erase(last_unique, walked.end());
+            REQUIRE(walked.size() == unique_rows.size());
+            for (size_t i = 0; i < walked.size(); ++i) {
+                CHECK(walked[i].name == unique_rows[i].name);
+                CHECK(walked[i].score == unique_rows[i].score);
+            }
+        }
+        THEN("rank is the first position of the name in a full sort") {
+            for (const std::string name : { "dog0", "dog13", "dog699" }) {
+                auto it = std::find_if(rows.begin(), rows.end(), [&name](const Row& row) {
+                    return row.name == name;
+                });
+                auto rank = board.FindRank(name);
+                REQUIRE(rank.has_value() == (it != rows.end()));
+                if (rank) {
+                    CHECK(rank->place == static_cast<size_t>(it - rows.begin()) + 1);
+                }
+            }
+        }
+    }
+}
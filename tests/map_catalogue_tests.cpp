@@ -0,0 +1,26 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../src/map_catalogue.h"
+
+using api_handler::MapCatalogue;
+
+SCENARIO("If-None-Match against map ETag") {
+    const std::string etag = "\"0123456789abcdef\"";
+
+    WHEN("the header holds the same tag") {
+        CHECK(MapCatalogue::MatchesETag("\"0123456789abcdef\"", etag));
+    }
+    WHEN("the header is a wildcard") {
+        CHECK(MapCatalogue::MatchesETag(" * ", etag));
+    }
+    WHEN("the tag is weak or one of several") {
+        CHECK(MapCatalogue::MatchesETag("W/\"0123456789abcdef\"", etag));
+        CHECK(MapCatalogue::MatchesETag("\"1111111111111111\", \"0123456789abcdef\"", etag));
+        CHECK(MapCatalogue::MatchesETag("\"1111111111111111\",W/\"0123456789abcdef\" ", etag));
+    }
+    WHEN("no tag matches") {
+        CHECK_FALSE(MapCatalogue::MatchesETag("", etag));
+        CHECK_FALSE(MapCatalogue::MatchesETag("\"1111111111111111\"", etag));
+        CHECK_FALSE(MapCatalogue::MatchesETag("0123456789abcdef", etag));
+        CHECK_FALSE(MapCatalogue::MatchesETag("\"0123456789abcdef\"x", etag));
+    }
+}
@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include "../src/mpsc_queue.h"
+
+SCENARIO("MPSC queue") {
+    GIVEN("an empty queue") {
+        util::MpscQueue<int> queue;
+        int value = 0;
+
+        THEN("nothing can be popped") {
+            CHECK_FALSE(queue.TryPop(value));
+        }
+
+        WHEN("one producer pushes values") {
+            for (int i = 0; i < 5; ++i) {
+                queue.Push(i);
+            }
+
+            THEN("they are popped in the same order") {
+                for (int i = 0; i < 5; ++i) {
+                    REQUIRE(queue.TryPop(value));
+                    CHECK(value == i);
+                }
+                CHECK_FALSE(queue.TryPop(value));
+            }
+        }
+
+        WHEN("several producers push concurrently") {
+            const int producers = 4;
+            const int per_producer = 10000;
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; ++p) {
+                threads.emplace_back([&queue, p] {
+                    for (int i = 0; i < per_producer; ++i) {
+                        queue.Push(p * per_producer + i);
+                    }
+                });
+            }
+
+            // читатель работает параллельно с писателями
+            std::vector<int> last(producers, -1);
+            int popped = 0;
+            bool ordered = true;
+            while (popped < producers * per_producer) {
+                if (queue.TryPop(value)) {
+                    const int p = value / per_producer;
+                    ordered = ordered && value % per_producer == last[p] + 1;
+                    last[p] = value % per_producer;
+                    ++popped;
+                }
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            THEN("every value arrives once and in per-producer order") {
+                CHECK(ordered);
+                CHECK_FALSE(queue.TryPop(value));
+            }
+        }
+    }
+}
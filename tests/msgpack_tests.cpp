@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <string>
+#include "../src/msgpack.h"
+
+using namespace std::literals;
+
+SCENARIO("MessagePack writer and reader") {
+    GIVEN("an empty buffer") {
+        std::string buffer;
+        wire::MsgPackWriter writer(buffer);
+
+        WHEN("small values are written") {
+            writer.Uint(5);
+            writer.Int(-3);
+            writer.String("abc"sv);
+            writer.ArrayHeader(2);
+            writer.MapHeader(1);
+            writer.Nil();
+            writer.Bool(true);
+
+            THEN("the shortest encodings are used") {
+                CHECK(buffer == "\x05\xfd\xa3" "abc" "\x92\x81\xc0\xc3"s);
+            }
+        }
+
+        WHEN("values of every size are written") {
+            const std::uint64_t uints[] = { 0, 127, 128, 255, 256, 65535, 65536, 4294967295ull, 4294967296ull,
+                std::numeric_limits<std::uint64_t>::max() };
+            const std::int64_t ints[] = { -1, -32, -33, -128, -129, -32768, -32769, -2147483648ll, -2147483649ll,
+                std::numeric_limits<std::int64_t>::min() };
+            const double doubles[] = { 0.0, -1.5, 10.123456789, 1e300 };
+            const std::string long_string(70000, 'x');
+
+            for (auto value : uints) {
+                writer.Uint(value);
+            }
+            for (auto value : ints) {
+                writer.Int(value);
+            }
+            for (auto value : doubles) {
+                writer.Double(value);
+            }
+            writer.String(std::string(40, 'y'));
+            writer.String(std::string(300, 'z'));
+            writer.String(long_string);
+            writer.ArrayHeader(20);
+            writer.MapHeader(70000);
+
+            THEN("they are read back unchanged") {
+                wire::MsgPackReader reader(buffer);
+                for (auto value : uints) {
+                    CHECK(reader.Peek() == wire::MsgPackReader::Type::Uint);
+                    CHECK(reader.ReadUint() == value);
+                }
+                for (auto value : ints) {
+                    CHECK(reader.Peek() == wire::MsgPackReader::Type::Int);
+                    CHECK(reader.ReadInt() == value);
+                }
+                for (auto value : doubles) {
+                    CHECK(reader.ReadDouble() == value);
+                }
+                CHECK(reader.ReadString() == std::string(40, 'y'));
+                CHECK(reader.ReadString() == std::string(300, 'z'));
+                CHECK(reader.ReadString() == long_string);
+                CHECK(reader.ReadArrayHeader() == 20);
+                CHECK(reader.ReadMapHeader() == 70000);
+                CHECK(reader.AtEnd());
+            }
+        }
+
+        WHEN("nested values are skipped") {
+            writer.ArrayHeader(3);
+            writer.MapHeader(1);
+            writer.String("key"sv);
+            writer.ArrayHeader(2);
+            writer.Double(1.0);
+            writer.Int(-100);
+            writer.Nil();
+            writer.Bool(false);
+            writer.Uint(42);
+
+            THEN("the reader stops right after them") {
+                wire::MsgPackReader reader(buffer);
+                reader.Skip();
+                CHECK(reader.ReadUint() == 42);
+                CHECK(reader.AtEnd());
+            }
+        }
+
+        WHEN("the data is truncated or has another type") {
+            writer.String("abcdef"sv);
+            buffer.pop_back();
+
+            THEN("the reader throws") {
+                wire::MsgPackReader truncated(buffer);
+                CHECK_THROWS_AS(truncated.ReadString(), wire::MsgPackError);
+
+                wire::MsgPackReader wrong_type(buffer);
+                CHECK_THROWS_AS(wrong_type.ReadUint(), wire::MsgPackError);
+
+                wire::MsgPackReader empty(""sv);
+                CHECK_THROWS_AS(empty.Peek(), wire::MsgPackError);
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../src/rcu.h"
+
+namespace {
+
+// значение, которое сообщает о своем удалении
+struct Tracked {
+    Tracked(int value, std::atomic<int>& alive)
+        : value(value)
+        , check(value * 3)
+        , alive(alive) {
+        ++alive;
+    }
+    ~Tracked() {
+        --alive;
+    }
+
+    int value;
+    int check;
+    std::atomic<int>& alive;
+};
+
+}  // namespace
+
+SCENARIO("RCU cell") {
+    GIVEN("a cell in an epoch domain") {
+        std::atomic<int> alive = 0;
+        {
+            util::EpochDomain domain;
+            util::RcuCell<Tracked> cell(domain);
+
+            THEN("it is empty at first") {
+                auto guard = domain.Enter();
+                CHECK(cell.Load() == nullptr);
+            }
+
+            WHEN("a value is replaced without readers") {
+                cell.Publish(std::make_unique<Tracked>(1, alive));
+                cell.Publish(std::make_unique<Tracked>(2, alive));
+                CHECK(alive == 2);
+                domain.Advance();
+
+                THEN("the old value is freed") {
+                    CHECK(alive == 1);
+                    CHECK(domain.RetiredCount() == 0);
+                    auto guard = domain.Enter();
+                    CHECK(cell.Load()->value == 2);
+                }
+            }
+
+            WHEN("a reader holds the old value") {
+                cell.Publish(std::make_unique<Tracked>(1, alive));
+                domain.Advance();
+                auto guard = std::make_unique<util::EpochDomain::Guard>(domain.Enter());
+                const Tracked* old = cell.Load();
+
+                cell.Publish(std::make_unique<Tracked>(2, alive));
+                domain.Advance();
+                domain.Advance();
+
+                THEN("it is kept until the reader leaves") {
+                    CHECK(alive == 2);
+                    CHECK(old->value == 1);
+
+                    guard.reset();
+                    domain.Advance();
+                    CHECK(alive == 1);
+                }
+            }
+        }
+
+        THEN("everything is freed with the domain") {
+            CHECK(alive == 0);
+        }
+    }
+
+    GIVEN("readers running concurrently with a writer") {
+        std::atomic<int> alive = 0;
+        std::atomic<bool> broken = false;
+        {
+            util::EpochDomain domain;
+            util::RcuCell<Tracked> cell(domain);
+            cell.Publish(std::make_unique<Tracked>(0, alive));
+
+            const int publications = 20000;
+            std::atomic<bool> done = false;
+            std::vector<std::thread> readers;
+            for (int r = 0; r < 4; ++r) {
+                readers.emplace_back([&] {
+                    int last = 0;
+                    while (!done) {
+                        auto guard = domain.Enter();
+                        const Tracked* value = cell.Load();
+                        // значения не рвутся и не идут назад
+                        if (value->check != value->value * 3 || value->value < last) {
+                            broken = true;
+                        }
+                        last = value->value;
+                    }
+                });
+            }
+
+            for (int i = 1; i <= publications; ++i) {
+                cell.Publish(std::make_unique<Tracked>(i, alive));
+                domain.Advance();
+            }
+            done = true;
+            for (auto& reader : readers) {
+                reader.join();
+            }
+
+            CHECK_FALSE(broken);
+            domain.Advance();
+            // после ухода читателей остается только текущее значение
+            CHECK(domain.RetiredCount() == 0);
+            CHECK(alive == 1);
+        }
+        CHECK(alive == 0);
+    }
+}
@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/record_writer.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+db::GameRecords MakeRecord(int i) {
+    return { "dog" + std::to_string(i), static_cast<size_t>(i), 1000.0 * i };
+}
+
+}  // namespace
+
+SCENARIO("Write-behind of retired records") {
+    std::mutex mutex;
+    std::vector<size_t> batches;
+    std::vector<std::string> written;
+    auto flush = [&](const std::vector<db::GameRecords>& batch) {
+        std::lock_guard lock(mutex);
+        batches.push_back(batch.size());
+        for (const auto& record : batch) {
+            written.push_back(record.name);
+        }
+    };
+
+    GIVEN("a writer with a small batch and a long interval") {
+        db::RecordWriter writer(flush, { .batch_size = 4, .flush_interval = 10s });
+
+        WHEN("a full batch is enqueued") {
+            for (int i = 0; i < 4; ++i) {
+                writer.Enqueue(MakeRecord(i));
+            }
+            // пачка пишется по размеру, не дожидаясь интервала
+            for (int i = 0; i < 500 && writer.GetStats().written < 4; ++i) {
+                std::this_thread::sleep_for(2ms);
+            }
+
+            THEN("it is flushed as one batch") {
+                CHECK(writer.GetStats().written == 4);
+                CHECK(writer.GetStats().queue_depth == 0);
+                std::lock_guard lock(mutex);
+                CHECK(batches == std::vector<size_t>{ 4 });
+            }
+        }
+
+        WHEN("the writer stops with a partial batch") {
+            for (int i = 0; i < 6; ++i) {
+                writer.Enqueue(MakeRecord(i));
+            }
+            writer.Stop();
+
+            THEN("the queue is drained in order") {
+                CHECK(writer.GetStats().written == 6);
+                CHECK(writer.GetStats().queue_depth == 0);
+                CHECK(written == std::vector<std::string>{ "dog0", "dog1", "dog2", "dog3", "dog4", "dog5" });
+            }
+        }
+    }
+
+    GIVEN("a writer with a short interval") {
+        db::RecordWriter writer(flush, { .batch_size = 100, .flush_interval = 5ms });
+
+        WHEN("a single record is enqueued") {
+            writer.Enqueue(MakeRecord(1));
+            for (int i = 0; i < 500 && writer.GetStats().written < 1; ++i) {
+                std::this_thread::sleep_for(2ms);
+            }
+
+            THEN("it is flushed by time") {
+                CHECK(writer.GetStats().written == 1);
+            }
+        }
+    }
+
+    GIVEN("a database that fails the first flush") {
+        std::atomic<int> attempts{ 0 };
+        std::atomic<size_t> reported{ 0 };
+        db::RecordWriter writer([&](const std::vector<db::GameRecords>& batch) {
+            if (attempts++ == 0) {
+                throw std::runtime_error("connection lost");
+            }
+            flush(batch);
+        }, { .batch_size = 2, .flush_interval = 5ms });
+        writer.SetHandlers([&reported](const std::exception&, size_t batch_size) {
+            reported += batch_size;
+        }, {});
+
+        WHEN("records are enqueued") {
+            writer.Enqueue(MakeRecord(1));
+            writer.Enqueue(MakeRecord(2));
+            for (int i = 0; i < 500 && writer.GetStats().written < 2; ++i) {
+                std::this_thread::sleep_for(2ms);
+            }
+
+            THEN("the batch is retried and the error is reported") {
+                auto stats = writer.GetStats();
+                CHECK(stats.written == 2);
+                CHECK(stats.failed_flushes == 1);
+                CHECK(reported == 2);
+                CHECK(written == std::vector<std::string>{ "dog1", "dog2" });
+            }
+        }
+    }
+}
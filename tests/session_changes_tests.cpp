@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include "../src/session_changes.h"
+
+namespace {
+
+app::PlayerSnapshot MakePlayer(int id, std::uint64_t revision) {
+    app::PlayerSnapshot player{ id, "dog", {0, 0}, {0, 0}, model::Direction::North, {}, 0 };
+    player.revision = revision;
+    return player;
+}
+
+app::LootSnapshot MakeLoot(size_t id) {
+    return { id, model::Trophy(id, 0, {0, 0}) };
+}
+
+const app::PlayerSnapshot& FindPlayer(const app::SessionSnapshot& snapshot, int id) {
+    return *std::find_if(snapshot.players.begin(), snapshot.players.end(), [id](const app::PlayerSnapshot& player) {
+        return player.id == id;
+    });
+}
+
+}  // namespace
+
+SCENARIO("Session change tracking") {
+    GIVEN("a tracker and a session with two players and one trophy") {
+        app::SessionChangeTracker tracker;
+
+        app::SessionSnapshot first;
+        first.tick = 10;
+        first.players = { MakePlayer(1, 0), MakePlayer(2, 0) };
+        first.loot = { MakeLoot(100) };
+        const bool first_changed = tracker.Stamp(first);
+
+        THEN("everything is stamped with the first tick") {
+            CHECK(first_changed);
+            CHECK(FindPlayer(first, 1).changed_tick == 10);
+            CHECK(FindPlayer(first, 2).changed_tick == 10);
+            CHECK(first.loot[0].spawned_tick == 10);
+            CHECK(first.removed->empty());
+            CHECK(first.CanDiffSince(10));
+            CHECK_FALSE(first.CanDiffSince(9));
+            CHECK_FALSE(first.CanDiffSince(11));
+        }
+
+        WHEN("one player moves, one leaves and the trophy is replaced") {
+            app::SessionSnapshot second;
+            second.tick = 11;
+            second.players = { MakePlayer(1, 5) };
+            second.loot = { MakeLoot(101) };
+            const bool second_changed = tracker.Stamp(second);
+
+            THEN("only changed entities get the new tick") {
+                CHECK(second_changed);
+                CHECK(FindPlayer(second, 1).changed_tick == 11);
+                CHECK(second.loot[0].spawned_tick == 11);
+                REQUIRE(second.removed->size() == 2);
+                for (const auto& removed : *second.removed) {
+                    CHECK(removed.tick == 11);
+                    if (removed.kind == app::RemovedEntity::Kind::Player) {
+                        CHECK(removed.id == 2);
+                    }
+                    else {
+                        CHECK(removed.id == 100);
+                    }
+                }
+                CHECK(second.CanDiffSince(10));
+            }
+
+            AND_WHEN("nothing changes for a while") {
+                app::SessionSnapshot third;
+                third.tick = 12;
+                third.players = { MakePlayer(1, 5) };
+                third.loot = { MakeLoot(101) };
+                const bool third_changed = tracker.Stamp(third);
+
+                THEN("change ticks are kept and the removal list is shared") {
+                    CHECK_FALSE(third_changed);
+                    CHECK(FindPlayer(third, 1).changed_tick == 11);
+                    CHECK(third.loot[0].spawned_tick == 11);
+                    CHECK(third.removed == second.removed);
+                }
+            }
+
+            AND_WHEN("the removals fall out of the history") {
+                app::SessionSnapshot late;
+                late.tick = 11 + app::SessionChangeTracker::HISTORY_TICKS + 1;
+                late.players = { MakePlayer(1, 5) };
+                late.loot = { MakeLoot(101) };
+                tracker.Stamp(late);
+
+                THEN("older clients have to take a full snapshot") {
+                    CHECK(late.removed->empty());
+                    CHECK(late.history_from == 12);
+                    CHECK_FALSE(late.CanDiffSince(11));
+                    CHECK(late.CanDiffSince(12));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Cached delta body") {
+    GIVEN("a published snapshot") {
+        app::SessionSnapshot snapshot;
+        snapshot.tick = 20;
+        int builds = 0;
+        auto build = [&builds](const app::SessionSnapshot&, std::uint64_t since) {
+            ++builds;
+            return std::to_string(since);
+        };
+
+        WHEN("waiters ask for the same since") {
+            auto first = snapshot.GetDeltaBody(0, 19, build);
+            auto second = snapshot.GetDeltaBody(0, 19, build);
+
+            THEN("the body is encoded once and shared") {
+                CHECK(builds == 1);
+                CHECK(first == second);
+                CHECK(*first == "19");
+            }
+        }
+
+        WHEN("since or format differ") {
+            snapshot.GetDeltaBody(0, 19, build);
+            auto other_since = snapshot.GetDeltaBody(0, 15, build);
+            auto other_format = snapshot.GetDeltaBody(1, 15, build);
+
+            THEN("each is encoded separately") {
+                CHECK(builds == 3);
+                CHECK(*other_since == "15");
+                CHECK(*other_format == "15");
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+#include "../src/timer_wheel.h"
+
+SCENARIO("Timer wheel") {
+    GIVEN("a wheel with few slots") {
+        util::TimerWheel<int> wheel(10, 4);
+
+        WHEN("timers are scheduled") {
+            wheel.Schedule(25, 1);
+            wheel.Schedule(5, 2);
+            wheel.Schedule(25, 3);
+            wheel.Schedule(95, 4);
+
+            THEN("only expired timers fire, ordered by deadline") {
+                std::vector<int> fired;
+                auto collect = [&fired](int v) { fired.push_back(v); };
+
+                wheel.Advance(4, collect);
+                CHECK(fired.empty());
+
+                wheel.Advance(30, collect);
+                CHECK(fired == std::vector<int>{ 2, 1, 3 });
+                CHECK(wheel.Size() == 1);
+
+                fired.clear();
+                wheel.Advance(94, collect);
+                CHECK(fired.empty());
+                wheel.Advance(200, collect);
+                CHECK(fired == std::vector<int>{ 4 });
+                CHECK(wheel.Size() == 0);
+            }
+        }
+
+        WHEN("a timer is scheduled in the past") {
+            wheel.Advance(50, [](int) {});
+            wheel.Schedule(10, 7);
+
+            THEN("it fires on the next advance") {
+                std::vector<int> fired;
+                wheel.Advance(50, [&fired](int v) { fired.push_back(v); });
+                CHECK(fired == std::vector<int>{ 7 });
+            }
+        }
+    }
+}
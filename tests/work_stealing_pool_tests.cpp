@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <stdexcept>
+#include "../src/work_stealing_pool.h"
+
+SCENARIO("Work stealing pool") {
+    GIVEN("a pool with several workers") {
+        util::WorkStealingPool pool(4);
+        REQUIRE(pool.WorkersCount() == 4);
+
+        WHEN("tasks of different cost are run") {
+            const size_t count = 1000;
+            std::vector<std::atomic<int>> visits(count);
+            std::vector<size_t> results(count);
+            std::vector<size_t> workers(count);
+
+            pool.Run(count, [&](size_t worker, size_t index) {
+                // первые задачи тяжелее, их блок должны разобрать другие воркеры
+                volatile size_t sink = 0;
+                for (size_t i = 0; i < (index < 100 ? 20000 : 10); ++i) {
+                    sink = sink + i;
+                }
+                ++visits[index];
+                results[index] = index * 2;
+                workers[index] = worker;
+            });
+
+            THEN("every task runs exactly once") {
+                for (size_t i = 0; i < count; ++i) {
+                    CHECK(visits[i] == 1);
+                    CHECK(results[i] == i * 2);
+                    CHECK(workers[i] < 4);
+                }
+            }
+        }
+
+        WHEN("the pool is reused") {
+            std::atomic<size_t> sum = 0;
+            for (int round = 0; round < 50; ++round) {
+                pool.Run(10, [&sum](size_t, size_t index) {
+                    sum += index;
+                });
+            }
+
+            THEN("all rounds are completed") {
+                CHECK(sum == 50 * 45);
+            }
+        }
+
+        WHEN("a task throws") {
+            THEN("the exception is rethrown after all tasks finish") {
+                std::atomic<size_t> done = 0;
+                CHECK_THROWS_AS(pool.Run(100, [&done](size_t, size_t index) {
+                    ++done;
+                    if (index == 42) {
+                        throw std::runtime_error("task failed");
+                    }
+                }), std::runtime_error);
+                CHECK(done == 100);
+            }
+        }
+    }
+}